@@ -0,0 +1,103 @@
+// Benchmark of the triangulations on the point clouds of surfaces/ (or the .txt clouds of another folder) :
+// both insertion kernels of DelaunayTriangulation2D, with their InsertStats, then the 3d Delaunay of the
+// same clouds, serial and parallel. The mesh ids are 32 bits by default, build with TP_GEOM_INDEX_64 to compare the two layouts.
+//   BenchDelaunay [folder or .txt files...]
+#include <tp_geom/delaunay.h>
+#include <tp_geom/delaunay_3d.h>
+#include <tp_geom/pointcloud.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+#ifndef SURFACES_DIR
+#define SURFACES_DIR "surfaces"
+#endif
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+  using Kernel = DelaunayTriangulation2D::Kernel;
+
+  double seconds_since(Clock::time_point start){
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  }
+
+  double per_insert(size_t count, size_t inserts){
+    return inserts > 0 ? double(count) / inserts : 0;
+  }
+
+  void bench_2d(const std::vector<Vector>& points, Kernel kernel){
+    DelaunayTriangulation2D tri(kernel);
+    const auto start = Clock::now();
+    tri.build(points);
+    const double time = seconds_since(start);
+
+    const auto& stats = tri.get_insert_stats();
+    const auto& walks = tri.get_walk_stats();
+    const TriangleMesh& mesh = tri.get_mesh();
+    std::cout << (kernel == Kernel::Flips ? "  2d flips  " : "  2d cavity ") << std::setw(8) << time << "s"
+              << "  triangles " << mesh.triangles.size() - mesh.free_triangles.size()
+              << "  inserts " << stats.inserts << "  duplicates " << stats.duplicates
+              << "  flips/insert " << per_insert(stats.flips, stats.inserts)
+              << "  cavity/insert " << per_insert(stats.cavity_tris, stats.inserts)
+              << "  fallbacks " << stats.fallbacks
+              << "  steps/walk " << per_insert(walks.steps, walks.walks)
+              << "  delaunay " << TriMeshAlgorithm::is_delaunay_2d(mesh) << "\n";
+  }
+
+  // The clouds are terrains, their z makes them 3d clouds as is
+  void bench_3d(const std::vector<Vector>& points, bool parallel){
+    DelaunayTriangulation3D tri;
+    const auto start = Clock::now();
+    if (parallel) tri.build_parallel(points);
+    else tri.build(points);
+    const double time = seconds_since(start);
+
+    const auto& stats = tri.get_insert_stats();
+    const TetMesh& mesh = tri.get_mesh();
+    std::cout << (parallel ? "  3d parallel " : "  3d cavity   ") << std::setw(8) << time << "s"
+              << "  tets " << mesh.finite_tet_count()
+              << "  inserts " << stats.inserts << "  duplicates " << stats.duplicates
+              << "  cavity/insert " << per_insert(stats.cavity_tets, stats.inserts)
+              << "  steps/insert " << per_insert(stats.walk_steps, stats.inserts) << "\n";
+  }
+
+  std::vector<std::string> clouds(int argc, char** argv){
+    std::vector<std::string> paths;
+    const std::vector<std::string> args = argc > 1 ? std::vector<std::string>(argv + 1, argv + argc)
+                                                   : std::vector<std::string>{ SURFACES_DIR };
+
+    for (const std::string& arg : args){
+      if (!std::filesystem::is_directory(arg)){
+        paths.push_back(arg);
+        continue;
+      }
+
+      std::vector<std::string> found;
+      for (const auto& entry : std::filesystem::directory_iterator(arg))
+        if (entry.path().extension() == ".txt") found.push_back(entry.path().string());
+      std::sort(found.begin(), found.end());
+      paths.insert(paths.end(), found.begin(), found.end());
+    }
+
+    return paths;
+  }
+}
+
+int main(int argc, char** argv){
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "ids " << 8 * sizeof(MeshIndex) << " bits, " << sizeof(MTriangle) << " bytes per triangle\n";
+
+  for (const std::string& path : clouds(argc, argv)){
+    const std::vector<Vector> points = load_point_cloud(path);
+    std::cout << path << " : " << points.size() << " points\n";
+
+    bench_2d(points, Kernel::Flips);
+    bench_2d(points, Kernel::Cavity);
+    bench_3d(points, false);
+    bench_3d(points, true);
+  }
+
+  return 0;
+}
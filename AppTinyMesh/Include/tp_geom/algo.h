@@ -5,4 +5,7 @@ namespace TriMeshAlgorithm {
   SplitResult split_face(TriangleMesh& mesh, size_t tri_id, const Vector& point);
   size_t split_edge(TriangleMesh& mesh, const size_t tri_id, const LocalId<3> edge_id, const Vector& point);
   void edge_flip(TriangleMesh& mesh, const size_t tri_id_0, const LocalId<3> edge_id);
+  // Same without checking the whole mesh afterwards. Flips can run concurrently as long as none of them
+  // touches the two triangles, or the neighbours of the two triangles, of another one
+  void edge_flip_unchecked(TriangleMesh& mesh, const size_t tri_id_0, const LocalId<3> edge_id);
 }
@@ -0,0 +1,43 @@
+#pragma once
+#include "mesh.h"
+#include <vector>
+
+/** Alpha shapes of a Delaunay triangulation in the xy plane : the finite triangles whose circumradius is at
+  * most alpha. The radii are computed once and sorted, the shape of any alpha is then a prefix of this order
+  * found by a binary search, and its boundary is extracted in a time linear in its size.
+  * Only the triangles are kept (regularized shape), the edges and vertices left alone by them are dropped.
+  * The mesh must outlive the shape and stay unchanged.
+  */
+struct AlphaShape {
+  AlphaShape(const TriangleMesh& mesh);
+
+  // Triangles of the shape of alpha, the first ones of get_order()
+  size_t triangle_count(double alpha) const;
+  std::vector<size_t> triangles(double alpha) const;
+  bool contains(size_t tri_id, double alpha) const;
+  // Area of the xy projection of the shape, in O(log n)
+  double area(double alpha) const;
+
+  // Edges with the shape on their left and the outside (or the hull) on their right
+  std::vector<std::pair<size_t, size_t>> boundary_edges(double alpha) const;
+  // The same edges chained in closed loops of vertices : the outer boundaries are CCW, the holes CW.
+  // A vertex shared by two triangles only through their corner appears in two loops, or twice in one
+  std::vector<std::vector<size_t>> boundary_loops(double alpha) const;
+
+  // Finite triangles sorted by circumradius, and their radii. The radii are the alphas where the shape changes
+  const std::vector<size_t>& get_order() const { return order; }
+  const std::vector<double>& get_radii() const { return radii; }
+private:
+  const TriangleMesh* mesh;
+
+  std::vector<size_t> order;
+  std::vector<double> radii;
+  std::vector<double> area_prefix; // Area of order[0, i)
+  std::vector<size_t> rank;        // Position of each triangle in order, size_t_max for the infinite and the free ones
+  // Rank of the neighbour of order[i] across its edge e at 3 * i + e, the boundary is found by a sequential scan
+  std::vector<size_t> neighbour_ranks;
+
+  bool kept(size_t tri_id, size_t count) const { return rank[tri_id] < count; }
+  // Edges of the boundary, as (triangle of the shape, edge id)
+  std::vector<std::pair<size_t, LocalId<3>>> boundary_sides(size_t count) const;
+};
@@ -1,30 +1,229 @@
 #pragma once
 #include "mesh.h"
 #include "tp_geom/triangulation.h"
+#include "tp_geom/locator.h"
 
 /** Iterative solution for creating 2d triangles using a convex hull.
   * The convex hull is oriented CW, as opposed to the triangulation surface which is CCW
   */
 struct Triangulation2D : public TriangulationBase {
+  struct WalkStats {
+    size_t walks = 0;
+    size_t jumps = 0; // Walks started from a sampled vertex
+    size_t steps = 0; // Triangles crossed by all the walks
+  };
+
+  struct LocatedTri {
+    size_t triangle = size_t_max; // Finite triangle containing the point, or the one behind the hull edge facing it
+    std::array<double, 3> barycentric{0, 0, 0}; // Weights of the triangle vertices, extrapolated outside of the hull
+    bool inside = false;
+  };
+
+  // A point on an existing vertex (same x and y) isn't inserted, the id of the vertex is returned
   virtual size_t add_point(const Vector& point);
+  // Same as add_point, but the walk starts from hint_tri instead of the last located triangle
+  size_t add_point(const Vector& point, size_t hint_tri);
   static Triangulation2D from_point_cloud(const std::vector<Vector> points);
-private:
+
+  // Inserts the whole cloud in a spatially coherent order (BRIO), 
+  // each walk starts from the triangle of the previously inserted point.
+  // Returns the vertex id given to each input point
+  std::vector<size_t> build(const std::vector<Vector>& points);
+  // Same as build, on an empty triangulation whose convex hull is already known (ConvexHull::convex_hull_2d).
+  // The hull polygon is triangulated first, then the other points are all inside of it and never go
+  // through add_point_outside_hull. Falls back to build if the hull has less than 3 vertices
+  std::vector<size_t> build_from_hull(const std::vector<Vector>& points, const std::vector<size_t>& hull);
+
+  // Locates a batch of points in the current triangulation, in parallel
+  std::vector<LocatedTri> locate(const std::vector<Vector>& points) const;
+
+  // TriangleMesh::reorder and compact on the mesh being edited, the walk hint and the sampled vertices
+  // follow. The vertex ids held by the caller (from add_point, build) are to be remapped with the result
+  MeshRemap reorder(Ordering ordering = Ordering::Hilbert);
+  MeshRemap compact();
+
+  const WalkStats& get_walk_stats() const { return walk_stats; }
+  void reset_walk_stats() { walk_stats = {}; }
+protected:
   using FoundTri = std::tuple<size_t, char, TriOrient>;
-  using SplitResult = std::pair<size_t, std::array<size_t, 3>>;
+
+  // Triangle where the last walk ended, the next walk starts from there
+  size_t locate_hint = 0;
+  VertexSampleGrid sample_grid;
 
   FoundTri find_nearest_triangle(const Vector& point);
+  // Vertex of the found triangle at the same x and y as the point, or size_t_max.
+  // Before the first triangle (size_t_max), the two vertices at most waiting for it
+  size_t vertex_on(size_t tri_id, const Vector& point) const;
+  // Inserts a point located by find_nearest_triangle, it must not be on a vertex
+  size_t insert_located(const Vector& point, const FoundTri& found);
+private:
+  using SplitResult = std::pair<size_t, std::array<size_t, 3>>;
+
+  WalkStats walk_stats;
+
+  size_t start_triangle(const Vector& point, size_t hint_tri, bool& jumped) const;
+  FoundTri walk(const Vector& point, size_t tri_id, size_t& steps) const;
   void init_first_triangle();
   size_t add_point_outside_hull(size_t nearest_tri, const LocalId<3> nearest_eid, const Vector& point);
+  void remap_locator(const MeshRemap& remap);
 };
 
 struct DelaunayTriangulation2D : public Triangulation2D {
   using Base = Triangulation2D;
+  using Base::add_point;
+
+  // How an inserted point is made Delaunay
+  enum class Kernel {
+    Flips,  // Split the triangle containing the point, then flip the non Delaunay edges (Lawson)
+    Cavity  // Remove the triangles whose circumcircle contains the point, then fill the hole with a star (Bowyer-Watson)
+  };
+
+  struct InsertStats {
+    size_t inserts = 0;
+    size_t duplicates = 0;  // Points on an existing vertex, they get its id
+    size_t flips = 0;       // Edges flipped by the Flips kernel
+    size_t cavity_tris = 0; // Triangles removed by the Cavity kernel
+    size_t fallbacks = 0;   // Cavities broken by rounding errors, the point was inserted with flips instead
+    size_t removes = 0;
+    size_t local_moves = 0; // Moves that stayed in the star of the vertex, without a remove and an insert
+    size_t constraints = 0;
+    size_t constraint_tris = 0; // Triangles crossed by the constraints, triangulated again
+
+    InsertStats& operator+=(const InsertStats& other){
+      inserts += other.inserts;
+      duplicates += other.duplicates;
+      flips += other.flips;
+      cavity_tris += other.cavity_tris;
+      fallbacks += other.fallbacks;
+      removes += other.removes;
+      local_moves += other.local_moves;
+      constraints += other.constraints;
+      constraint_tris += other.constraint_tris;
+      return *this;
+    }
+  };
+
+  struct RefineCriteria {
+    double min_angle = 20; // Degrees. The refinement always ends up to ~20.7, in practice up to ~33
+    double max_area = std::numeric_limits<double>::infinity();
+    size_t max_steiner = size_t_max; // Stops after inserting this many points
+  };
+
+  struct RefineStats {
+    size_t segment_splits = 0; // Points inserted on the segments
+    size_t circumcenters = 0;
+    size_t rejected = 0;     // Circumcenters removed because they encroached segments, the segments were split instead
+    size_t small_angles = 0; // Bad triangles left in small input angles
+    size_t stale = 0;        // Queued triangles that were rewritten before their turn
+
+    size_t steiner() const { return segment_splits + circumcenters; }
+  };
+
+  DelaunayTriangulation2D(Kernel kernel = Kernel::Flips): kernel(kernel) {}
   size_t add_point(const Vector& point) override;
+
+  // Same as build, on an empty triangulation. The cloud is cut in kd cells triangulated in parallel,
+  // then stitched along the seams between the cells. pieces = 0 makes one cell per thread.
+  // Vertex i + 1 is points[i], unless it is a copy of an earlier point : it is then a free vertex and
+  // the point gets the id of the copy
+  std::vector<size_t> build_parallel(const std::vector<Vector>& points, size_t pieces = 0);
+
+  // Removes a vertex and fills its star with Delaunay ears, in O(degree^3) ~ O(1).
+  // The vertex and the two spare triangles go to the free lists of the mesh.
+  // Returns false and leaves the mesh untouched if less than 3 vertices would remain, or if they would be aligned,
+  // or if the vertex is the end of a constrained edge
+  bool remove_point(size_t vertex);
+  // Moves a vertex, it keeps its id. A vertex staying inside of its star is only moved, then the edges
+  // around it are flipped. Otherwise it is removed and inserted again.
+  // Returns false and leaves the mesh untouched if the point is on another vertex, or if remove_point fails
+  bool move_point(size_t vertex, const Vector& point);
+
+  // Makes the segment between two vertices an edge that is never flipped (constrained Delaunay), 
+  // like a breakline of a terrain. The triangles crossed by the segment are removed, and the two
+  // pseudo-polygons on each side of it are triangulated again. A vertex lying on the segment cuts it
+  // in two constrained edges. The points inserted later on a constrained edge split it in two.
+  // Returns false if the segment crosses another constrained edge, the pieces before the crossing are kept.
+  // Also false if the segment can't be walked (a and b at the same place), nothing is changed by this piece
+  bool insert_constraint(size_t a, size_t b);
+  // Inserts the segments along the Hilbert curve of their middles, returns how many were inserted
+  size_t insert_constraints(const std::vector<std::pair<size_t, size_t>>& segments);
+
+  // Delaunay refinement (Ruppert) : inserts Steiner points until no triangle has an angle under
+  // min_angle or an area over max_area. The segments are the constrained edges and the hull edges,
+  // the new points on them split them. The z of a new point is interpolated linearly
+  RefineStats refine(const RefineCriteria& criteria);
+
+  Kernel get_kernel() const { return kernel; }
+  const InsertStats& get_insert_stats() const { return insert_stats; }
+  void reset_insert_stats() { insert_stats = {}; }
+private:
+  Kernel kernel;
+  InsertStats insert_stats;
+
+  // Buffers of the Cavity kernel, kept to avoid allocations at each insertion
+  std::vector<size_t> cavity;
+  std::vector<std::pair<size_t, LocalId<3>>> cavity_boundary;
+  std::vector<size_t> cavity_rejected;
+  std::vector<char> cavity_state;
+
+  struct StarTri { size_t a, b, outer; LocalId<3> outer_edge; size_t slot; bool constrained; };
+  std::vector<StarTri> star;
+  std::vector<std::pair<size_t, size_t>> star_by_a;
+
+  // Buffers of remove_point, the hole left by the vertex and the ears filling it
+  struct Ear { size_t prev, id, next; };
+  std::vector<size_t> hole;       // Vertices around the removed one, CCW
+  std::vector<size_t> hole_tris;  // Triangles of its star, their slots are reused
+  std::vector<size_t> hole_outer; // Triangle on the other side of the hole edge (hole[i], hole[i + 1])
+  std::vector<char> hole_constrained;
+  std::vector<size_t> hole_next, hole_prev;
+  std::vector<Ear> ears;
+
+  // Buffers of insert_constraint : the triangles crossed by the segment, the vertices on each side
+  // and the edges around them
+  struct CorridorEdge { size_t a, b, outer; bool constrained; };
+  std::vector<size_t> corridor;
+  std::vector<size_t> corridor_left, corridor_right;
+  std::vector<size_t> corridor_inner; // Vertices enclosed by the corridor, inserted again afterwards
+  std::vector<CorridorEdge> corridor_boundary;
+
+  // Inserts (a, b) up to the first vertex on it, returns this vertex or size_t_max if a constraint is crossed
+  // or if the walk along the segment fails, nothing is changed then
+  size_t insert_constraint_piece(size_t a, size_t b);
+  // Triangulates the pseudo-polygon made of the edge (u, w) and chain[first, last), chain[first] being next to u.
+  // Returns the triangle on the edge (u, w)
+  size_t fill_pseudo_polygon(size_t u, size_t w, const std::vector<size_t>& chain, size_t first, size_t last, size_t& next_slot);
+
+  // Splits an edge at a point close to it, even if rounding puts the point slightly on one side
+  size_t split_segment(size_t tri_id, LocalId<3> edge_id, const Vector& point);
+
+  bool is_ear(size_t id) const;
+  // Flips the edges around a vertex until they are Delaunay
+  void restore_delaunay_around(size_t vertex);
+
+  size_t insert_with_flips(const Vector& point, const FoundTri& found);
+  // Returns size_t_max and leaves the mesh untouched if the cavity isn't a star around the point
+  size_t insert_in_cavity(const Vector& point, const FoundTri& found);
 };
 
 namespace TriMeshAlgorithm {
+  struct FlipStats {
+    size_t flips = 0;
+    size_t tests = 0;  // In-circle tests of queued edges
+    size_t passes = 0; // Rounds of the worklist, the first one tests every edge
+    size_t conflicts = 0; // Parallel version : non Delaunay edges postponed because a neighbour flip had priority
+  };
+
   bool is_delaunay_2d(const TriangleMesh& mesh);
   bool is_edge_delaunay_2d(const TriangleMesh& mesh, const size_t tri_id, const LocalId<3> edge_id);
   bool fully_delaunay(const TriangleMesh &mesh, const size_t tri_id, const LocalId<3> edge_id);
-  TriangleMesh to_delaunay(const Triangulation2D& tri);
+
+  // Flips the non Delaunay edges (Lawson) until there are none left. After a flip only the
+  // 4 edges around it are tested again, so the cost after the first pass is O(flips)
+  FlipStats make_delaunay(TriangleMesh& mesh);
+  // Same result as make_delaunay up to the order of the flips (the mesh is identical unless
+  // there are cocircular points), the independent flips of each round run in parallel
+  FlipStats make_delaunay_parallel(TriangleMesh& mesh);
+  TriangleMesh to_delaunay(const Triangulation2D& tri, FlipStats* stats = nullptr);
 }
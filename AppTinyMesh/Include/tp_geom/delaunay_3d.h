@@ -0,0 +1,81 @@
+#pragma once
+#include "tp_geom/tet_mesh.h"
+#include <map>
+
+/** Incremental Delaunay tetrahedralization. Each point is located by a visibility walk from the last
+  * created tet, then inserted by Bowyer-Watson : the tets whose circumsphere holds it are removed, and
+  * the faces of the hole are joined to it. The predicates are exact, coplanar and cospherical points are fine.
+  */
+struct DelaunayTriangulation3D {
+  struct InsertStats {
+    size_t inserts = 0;
+    size_t duplicates = 0;  // Points on an existing vertex, they get its id
+    size_t cavity_tets = 0; // Tets removed by the cavities
+    size_t walk_steps = 0;  // Tets crossed by the walks
+
+    InsertStats& operator+=(const InsertStats& other){
+      inserts += other.inserts;
+      duplicates += other.duplicates;
+      cavity_tets += other.cavity_tets;
+      walk_steps += other.walk_steps;
+      return *this;
+    }
+  };
+
+  // Returns the vertex id of the point. The points are only kept until 4 of them aren't coplanar,
+  // they are inserted once the first tet is made
+  size_t add_point(const Vector& point);
+  // Inserts the cloud in a BRIO order along a 3d Hilbert curve, returns the vertex id given to each point.
+  // The mesh stays without tet if all the points are coplanar
+  std::vector<size_t> build(const std::vector<Vector>& points);
+  // Same as build, on an empty triangulation. The cloud is cut in kd cells tetrahedralized in parallel,
+  // then stitched along the seams between the cells, as DelaunayTriangulation2D::build_parallel.
+  // pieces = 0 makes one cell per thread. Vertex i + 1 is points[i], unless it is a copy of an earlier
+  // point : it is then a vertex without tet and the point gets the id of the copy
+  std::vector<size_t> build_parallel(const std::vector<Vector>& points, size_t pieces = 0);
+
+  const TetMesh& get_mesh() const { return mesh; }
+  TetMesh&& extract_mesh() { return std::move(mesh); }
+  const InsertStats& get_insert_stats() const { return insert_stats; }
+private:
+  TetMesh mesh;
+  InsertStats insert_stats;
+
+  size_t locate_hint = 0;
+  uint32_t coin = 0x9E3779B9u;
+
+  // Points given before the first tet, and the first ones among them that are distinct, then not aligned
+  std::vector<size_t> pending;
+  std::map<std::array<double, 3>, size_t> pending_ids;
+  size_t first[3] = { size_t_max, size_t_max, size_t_max };
+
+  // Buffers of an insertion, tet_state is Unknown out of them
+  enum : char { Unknown = 0, InCavity, Rejected };
+  struct BoundaryFace {
+    std::array<MTet::Id, 4> vertices; // Of the cavity tet, the new vertex replaces vertices[face]
+    size_t outer; // Tet on the other side, and its face
+    uint8_t face;
+    uint8_t outer_face;
+  };
+  struct EdgeSlot { size_t a, b, tet; int face; };
+  std::vector<size_t> cavity;
+  std::vector<size_t> cavity_rejected;
+  std::vector<char> tet_state;
+  std::vector<BoundaryFace> boundary;
+  std::vector<EdgeSlot> edge_table; // Faces of the new tets around the new vertex, by their edge opposite to it
+  std::vector<size_t> edge_used;
+
+  bool init_first_tet(size_t vertex);
+  // Finite tet holding the point, or infinite tet whose hull face is visible from it
+  size_t walk(const Vector& point, size_t tet_id);
+  bool in_conflict(size_t tet_id, const Vector& point) const;
+  // Vertex of the tet on the point, size_t_max if there is none
+  size_t vertex_on(size_t tet_id, const Vector& point) const;
+  // Inserts the vertex from a tet in conflict with it
+  void insert(size_t vertex, size_t seed);
+};
+
+namespace TetMeshAlgorithm {
+  // No vertex strictly inside the circumsphere of a neighbouring tet
+  bool is_delaunay_3d(const TetMesh& mesh);
+}
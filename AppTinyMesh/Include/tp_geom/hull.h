@@ -0,0 +1,23 @@
+#pragma once
+#include "utils.h"
+#include <vector>
+
+/** Convex hull of a cloud on the xy plane, without building a triangulation.
+  * The points strictly inside the octagon of the extreme points are dropped first (Akl-Toussaint),
+  * each thread then runs a monotone chain on its share of the others, and a last monotone chain
+  * merges the partial hulls.
+  */
+namespace ConvexHull {
+  struct HullStats {
+    size_t kept = 0;    // Points left by the octagon filter
+    size_t partial = 0; // Vertices of the partial hulls, merged at the end
+  };
+
+  // Indices of the hull vertices, CCW from the lowest of the leftmost points. The points aligned on an edge
+  // aren't vertices, and a vertex given several times is the smallest of its indices.
+  // Less than 3 vertices if the cloud is aligned
+  std::vector<size_t> convex_hull_2d(const std::vector<Vector>& points, HullStats* stats = nullptr);
+
+  // Edges of the hull, the infinite triangles of a triangulation of the cloud. 0 if the cloud is aligned
+  size_t hull_edge_count(const std::vector<Vector>& points);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "mesh.h"
+#include <vector>
+
+/** Jump-and-walk accelerator for the point location.
+  * Keeps a sample of about sqrt(n) vertices bucketed in a uniform grid,
+  * a walk can then start from the triangle of the sampled vertex nearest to the query.
+  */
+struct VertexSampleGrid {
+  // Must be called for every inserted vertex, keeps it if the sample is too small
+  void insert(const TriangleMesh& mesh, size_t vertex);
+  // Must be called before a vertex is removed, while it still has its position
+  void erase(const TriangleMesh& mesh, size_t vertex);
+  // Nearest sampled vertex (approximately), size_t_max if nothing was sampled yet
+  // or if the query is already closer than a grid cell to its start (squared distance start_d2)
+  size_t nearest(const TriangleMesh& mesh, const Vector& point, double start_d2 = std::numeric_limits<double>::infinity()) const;
+
+  // Samples the vertices of a mesh built without insert
+  void assign(const TriangleMesh& mesh);
+  // The mesh was renumbered (TriangleMesh::reorder or compact), the samples follow their vertices
+  void remap(const std::vector<size_t>& new_ids);
+  void clear();
+  size_t size() const { return samples.size(); }
+private:
+  std::vector<size_t> samples;
+  std::vector<std::vector<size_t>> cells;
+  size_t seen = 0;
+  size_t rebuild_at = 0;
+
+  double min_x = 0, min_y = 0, cell_size = 1;
+  size_t side = 0;
+
+  void rebuild(const TriangleMesh& mesh);
+  size_t cell_coord(double v, double min) const;
+};
@@ -2,41 +2,133 @@
 #include "utils.h"
 #include <vector>
 #include <array>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <type_traits>
+
+// Id stored on fewer bits than size_t, it reads and writes as a size_t. Its largest value stands for
+// size_t_max, the code keeps comparing the ids with size_t_max whatever their storage
+template <typename T>
+struct CompactIndex {
+  T value;
+
+  CompactIndex() = default;
+  CompactIndex(size_t id): value(T(id)) { assert(id == size_t_max || id < std::numeric_limits<T>::max()); }
+  operator size_t() const { return value == std::numeric_limits<T>::max() ? size_t_max : value; }
+};
+
+template <typename Index>
+using StoredIndex = std::conditional_t<std::is_same_v<Index, size_t>, size_t, CompactIndex<Index>>;
+
+// Integer behind a stored id, written by the omp atomic of the parallel passes. The id must be valid
+inline size_t& raw_id(size_t& id) { return id; }
+template <typename T>
+T& raw_id(CompactIndex<T>& id) { return id.value; }
+
+// Neighbour across an edge, packed with the id of the same edge in the neighbour (corner table) : the way
+// back is then known without searching the neighbour. Set from a triangle id alone, the edge is unknown
+// and found by BasicTriangleMesh::opposite_edge. Reads as the id of the neighbour, or size_t_max
+template <typename Index>
+struct Adjacency {
+  static constexpr Index none = std::numeric_limits<Index>::max();
+  static constexpr int unknown_edge = 3;
+
+  Index packed; // tri_id << 2 | edge
+
+  Adjacency() = default;
+  Adjacency(size_t tri_id): Adjacency(tri_id, unknown_edge) {}
+  Adjacency(size_t tri_id, int edge): packed(tri_id == size_t_max ? none : Index(tri_id << 2 | edge)) { assert(tri_id == size_t_max || tri_id < none >> 2); }
+  operator size_t() const { return packed == none ? size_t_max : packed >> 2; }
+  int edge() const { return packed & 3; }
+};
+
+template <typename Index> struct BasicTriangleMesh;
+template <typename Index> struct BasicFaceAroundVIt;
+
+// Orders of the vertices and triangles of a mesh in memory
+enum class Ordering {
+  Hilbert // Along a Hilbert curve of the xy plane, the neighbours of an element are stored next to it
+};
+
+// New id of each old vertex and triangle of a mesh whose storage was reorganized, size_t_max when dropped
+struct MeshRemap {
+  std::vector<size_t> vertices;
+  std::vector<size_t> triangles;
+};
+
+// The ids are stored as Index, 32 bits are enough under 4G vertices and 1G triangles and halve the size of the mesh
+template <typename Index>
+struct BasicMTriangle {
+  using Id = StoredIndex<Index>;
 
-struct MTriangle {
-  std::array<size_t, 3> vertices{size_t_max, size_t_max, size_t_max};
-  std::array<size_t, 3> opposite_triangle{size_t_max, size_t_max, size_t_max};
+  std::array<Id, 3> vertices{size_t_max, size_t_max, size_t_max};
+  std::array<Adjacency<Index>, 3> opposite_triangle{size_t_max, size_t_max, size_t_max};
+  // Bit i is set when edge i is a constraint, the flag is held by both triangles of the edge
+  uint8_t constraints = 0;
 
-  MTriangle() {}
-  MTriangle(const std::array<size_t, 3>& v): vertices(v) {};
-  MTriangle(const std::array<size_t, 3>& v, const std::array<size_t, 3>& f): vertices(v), opposite_triangle(f) {};
+  BasicMTriangle() {}
+  BasicMTriangle(const std::array<size_t, 3>& v): vertices{v[0], v[1], v[2]} {};
+  BasicMTriangle(const std::array<size_t, 3>& v, const std::array<size_t, 3>& f): vertices{v[0], v[1], v[2]}, opposite_triangle{f[0], f[1], f[2]} {};
 
   LocalId<3> local_id_of(size_t v) const;
   bool is_infinite() const;
+  // Slot of a removed triangle, waiting in the free list of the mesh
+  bool is_free() const { return vertices[0] == size_t_max; }
+  bool is_constrained(LocalId<3> e) const { return constraints >> e & 1; }
+  void set_constrained(LocalId<3> e, bool constrained) { constraints = (constraints & ~(1 << e)) | constrained << e; }
 
   std::pair<size_t, size_t> get_edge(LocalId<3>) const;
   LocalId<3> find_edge(size_t a, size_t b) const;
   LocalId<3> find_edge(std::pair<size_t, size_t>) const;
 };
 
-struct FaceAroundVIt;
+template <typename Index>
+struct BasicTriangleMesh {
+  using MTriangle = BasicMTriangle<Index>;
+  using FaceAroundVIt = BasicFaceAroundVIt<Index>;
 
-struct TriangleMesh {
   std::vector<Vector> vertices;
-  std::vector<size_t> vertex_to_triangle;
+  std::vector<StoredIndex<Index>> vertex_to_triangle;
   std::vector<MTriangle> triangles;
+
+  // Slots of the removed vertices and triangles, the next additions reuse them (last freed first).
+  // A free vertex has no triangle, a free triangle has no vertices
+  std::vector<size_t> free_vertices;
+  std::vector<size_t> free_triangles;
   
   static constexpr size_t infinite_point = 0;
   static constexpr size_t v_start_offset = infinite_point + 1;
+  // Most vertices and triangles the ids can hold, the largest id stands for size_t_max and the links to the
+  // neighbours keep 2 bits for the edge : 4G vertices and 1G triangles with 32 bits
+  static constexpr size_t max_vertices = std::numeric_limits<Index>::max();
+  static constexpr size_t max_triangles = Adjacency<Index>::none >> 2;
 
-  TriangleMesh();
+  BasicTriangleMesh();
 
+  // Both throw std::length_error when the mesh is full (max_vertices, max_triangles), as a std::vector
   size_t add_point(const Vector& point);
+  // Id of an empty triangle, the caller fills it
+  size_t add_triangle();
+  // Same error if the mesh is grown by hand over these sizes (resize of the arrays)
+  static void check_size(size_t vertex_count, size_t triangle_count);
+  void remove_point(size_t vertex);
+  // The next add_point gives back the id of this free vertex, whatever its place in the free list
+  void reuse_next(size_t vertex);
+  void remove_triangle(size_t tri_id);
+  bool is_free_vertex(size_t vertex) const { return vertex != infinite_point && vertex_to_triangle[vertex] == size_t_max; }
 
   template <unsigned long N>
   void add_points(const std::array<Vector, N>& points);
 
+  // Renumbers the vertices and triangles in the given order, to be run once the mesh is built and before
+  // the passes that circulate around the vertices. The infinite vertex stays 0 and the free slots move at
+  // the end. The ids held outside of the mesh (locate hints, vertex ids returned by build) are to be remapped
+  MeshRemap reorder(Ordering ordering = Ordering::Hilbert);
+  // Drops the free slots, the others keep their order and the free lists are emptied.
+  // For meshes edited for long (removals, cavities), the memory is again the one of what is left
+  MeshRemap compact();
+
   void clear();
   bool is_empty() { return vertices.empty(); }
 
@@ -49,23 +141,45 @@ struct TriangleMesh {
   Vector get_vertex(const MTriangle &tri, char v) const { return vertices[tri.vertices[v]]; }
   std::array<Vector, 3> get_vertices(const MTriangle &tri) const;
 
+  // Id of the edge e of tri in the triangle across it, read from the link when it holds it
+  LocalId<3> opposite_edge(const MTriangle& tri, LocalId<3> e) const {
+    const int edge = tri.opposite_triangle[e].edge();
+    if (edge != Adjacency<Index>::unknown_edge) return edge;
+    return triangles[tri.opposite_triangle[e]].find_edge(tri.get_edge(e));
+  }
+
+  // Edge e0 of t0 and edge e1 of t1 become the same edge, t1 may be size_t_max
+  void link(size_t t0, LocalId<3> e0, size_t t1, LocalId<3> e1) {
+    triangles[t0].opposite_triangle[e0] = { t1, e1 };
+    if (t1 != size_t_max) triangles[t1].opposite_triangle[e1] = { t0, e0 };
+  }
+
   // Pas besoins de circulateurs ... juste renvoie un tableau
   // std::vector<MTriangle *> faces_around_v(size_t vertex);
 
   FaceAroundVIt faces_around_v(size_t vertex);
-  using LaplacianFunc = std::function<double(TriangleMesh &, size_t)>;
+  using LaplacianFunc = std::function<double(BasicTriangleMesh &, size_t)>;
   double laplacian(size_t vertex, const LaplacianFunc &compute);
+private:
+  // Moves the vertices and triangles to their new ids in arrays of the given sizes, the dropped ones are lost
+  void apply(const MeshRemap& remap, size_t vertex_count, size_t triangle_count);
 };
 
+template <typename Index>
 template <unsigned long N>
-void TriangleMesh::add_points(const std::array<Vector,N>& points){
+void BasicTriangleMesh<Index>::add_points(const std::array<Vector,N>& points){
   vertices.insert(vertices.end(), points.begin(), points.end());
   vertex_to_triangle.resize(vertex_to_triangle.size() + points.size(), size_t_max);
 }
 
-struct FaceAroundVIt {
-  FaceAroundVIt(){}
-  FaceAroundVIt(TriangleMesh *mesh, size_t triangle, size_t vertex)
+template <typename Index>
+struct BasicFaceAroundVIt {
+  using MTriangle = BasicMTriangle<Index>;
+  using TriangleMesh = BasicTriangleMesh<Index>;
+  using FaceAroundVIt = BasicFaceAroundVIt;
+
+  BasicFaceAroundVIt(){}
+  BasicFaceAroundVIt(TriangleMesh *mesh, size_t triangle, size_t vertex)
       : mesh(mesh), triangle(triangle), vertex(vertex) {}
 
   MTriangle *get_triangle() const { return &mesh->triangles[triangle]; }
@@ -90,6 +204,21 @@ private:
   size_t vertex;
 };
 
+// Storage of the ids of the meshes : 32 bits, or size_t with TP_GEOM_INDEX_64 for meshes over 4G vertices
+// or 1G triangles (the links to the neighbours keep 2 bits for the edge). A 2d Delaunay triangulation has
+// about 2 triangles per point, the 32 bits ids hold it up to ~500M points. Past the limits the 32 bits meshes
+// throw std::length_error instead of wrapping the ids around (BasicTriangleMesh::check_size).
+// The algorithms work on this one, the other one is instantiated too
+#ifdef TP_GEOM_INDEX_64
+using MeshIndex = size_t;
+#else
+using MeshIndex = uint32_t;
+#endif
+
+using MTriangle = BasicMTriangle<MeshIndex>;
+using TriangleMesh = BasicTriangleMesh<MeshIndex>;
+using FaceAroundVIt = BasicFaceAroundVIt<MeshIndex>;
+
 // asserts that the triangle has valid vertices id, has a valid orientation
 void assert_triangles_valid(const TriangleMesh& m, const bool orient_test = true, const bool connectivity_test = true);
 void assert_vertices_valid(const TriangleMesh& m);
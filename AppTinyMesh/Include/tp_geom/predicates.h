@@ -0,0 +1,178 @@
+#pragma once
+#include <mathematics.h>
+#include <cmath>
+#include <limits>
+
+/** Robust orientation and in-circle tests on the xy projection, orientation and in-sphere tests in 3d (Shewchuk).
+  * A floating point filter gives the sign of almost every input, when the result is too
+  * close to zero to be trusted it is computed again exactly with floating point expansions.
+  */
+namespace Predicates {
+  struct Stats {
+    size_t orient_calls = 0;
+    size_t orient_exact = 0; // Calls the filter couldn't decide
+    size_t in_circle_calls = 0;
+    size_t in_circle_exact = 0;
+    size_t orient_3d_calls = 0;
+    size_t orient_3d_exact = 0;
+    size_t in_sphere_calls = 0;
+    size_t in_sphere_exact = 0;
+  };
+
+  // Counters of the calling thread
+  inline thread_local Stats stats;
+
+  // Half an ulp of 1, bound of the relative rounding error
+  static constexpr double epsilon = std::numeric_limits<double>::epsilon() / 2;
+
+  double orient_2d_exact(const Vector& a, const Vector& b, const Vector& c);
+  double in_circle_exact(const Vector& a, const Vector& b, const Vector& c, const Vector& d);
+  double orient_3d_exact(const Vector& a, const Vector& b, const Vector& c, const Vector& d);
+  double in_sphere_exact(const Vector& a, const Vector& b, const Vector& c, const Vector& d, const Vector& e);
+
+  // Coordinates of one corner for a batch of tests
+  struct SoaPoints {
+    const double* x;
+    const double* y;
+  };
+
+  // Batch versions, the filters run on 4 (AVX2) or 8 (AVX-512) tests at once when the cpu has them.
+  // sign[i] is -1, 0 or 1, the sign of the exact result of test i
+  void orient_2d_batch(size_t n, SoaPoints a, SoaPoints b, SoaPoints c, signed char* sign);
+  void in_circle_batch(size_t n, SoaPoints a, SoaPoints b, SoaPoints c, SoaPoints d, signed char* sign);
+
+  // Instruction set picked for the batch tests : "avx512", "avx2" or "scalar"
+  const char* batch_isa();
+
+  // Positive if a, b, c are CCW, negative if CW, 0 if aligned. Only the sign is exact
+  inline double orient_2d(const Vector& a, const Vector& b, const Vector& c){
+    constexpr double err_bound = (3 + 16 * epsilon) * epsilon;
+    stats.orient_calls++;
+
+    const double left = (a[0] - c[0]) * (b[1] - c[1]);
+    const double right = (a[1] - c[1]) * (b[0] - c[0]);
+    const double det = left - right;
+
+    // The products have the sign of the exact ones, opposite signs can't cancel
+    double sum;
+    if (left > 0){
+      if (right <= 0) return det;
+      sum = left + right;
+    }
+    else if (left < 0){
+      if (right >= 0) return det;
+      sum = -left - right;
+    }
+    else
+      return det;
+
+    if (std::abs(det) >= err_bound * sum) return det;
+
+    stats.orient_exact++;
+    return orient_2d_exact(a, b, c);
+  }
+
+  // Positive if d is inside the circumcircle of the CCW triangle a, b, c, negative outside, 0 on it.
+  // Only the sign is exact
+  inline double in_circle(const Vector& a, const Vector& b, const Vector& c, const Vector& d){
+    constexpr double err_bound = (10 + 96 * epsilon) * epsilon;
+    stats.in_circle_calls++;
+
+    const double adx = a[0] - d[0], ady = a[1] - d[1];
+    const double bdx = b[0] - d[0], bdy = b[1] - d[1];
+    const double cdx = c[0] - d[0], cdy = c[1] - d[1];
+
+    const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    const double cdxady = cdx * ady, adxcdy = adx * cdy;
+    const double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    const double a_lift = adx * adx + ady * ady;
+    const double b_lift = bdx * bdx + bdy * bdy;
+    const double c_lift = cdx * cdx + cdy * cdy;
+
+    const double det = a_lift * (bdxcdy - cdxbdy) + b_lift * (cdxady - adxcdy) + c_lift * (adxbdy - bdxady);
+    const double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * a_lift
+                           + (std::abs(cdxady) + std::abs(adxcdy)) * b_lift
+                           + (std::abs(adxbdy) + std::abs(bdxady)) * c_lift;
+
+    if (std::abs(det) > err_bound * permanent) return det;
+
+    stats.in_circle_exact++;
+    return in_circle_exact(a, b, c, d);
+  }
+
+  // Positive if d is above the plane of a, b, c, on the side where they are CCW, negative below, 0 if coplanar.
+  // Only the sign is exact
+  inline double orient_3d(const Vector& a, const Vector& b, const Vector& c, const Vector& d){
+    constexpr double err_bound = (7 + 56 * epsilon) * epsilon;
+    stats.orient_3d_calls++;
+
+    const double adx = a[0] - d[0], ady = a[1] - d[1], adz = a[2] - d[2];
+    const double bdx = b[0] - d[0], bdy = b[1] - d[1], bdz = b[2] - d[2];
+    const double cdx = c[0] - d[0], cdy = c[1] - d[1], cdz = c[2] - d[2];
+
+    const double bdycdz = bdy * cdz, bdzcdy = bdz * cdy;
+    const double cdyadz = cdy * adz, cdzady = cdz * ady;
+    const double adybdz = ady * bdz, adzbdy = adz * bdy;
+
+    // Determinant of (a - d, b - d, c - d), its sign is the opposite of ours
+    const double det = adx * (bdycdz - bdzcdy) + bdx * (cdyadz - cdzady) + cdx * (adybdz - adzbdy);
+    const double permanent = (std::abs(bdycdz) + std::abs(bdzcdy)) * std::abs(adx)
+                           + (std::abs(cdyadz) + std::abs(cdzady)) * std::abs(bdx)
+                           + (std::abs(adybdz) + std::abs(adzbdy)) * std::abs(cdx);
+
+    if (std::abs(det) > err_bound * permanent) return -det;
+
+    stats.orient_3d_exact++;
+    return orient_3d_exact(a, b, c, d);
+  }
+
+  // Positive if e is inside the circumsphere of a, b, c, d (orient_3d(a, b, c, d) > 0), negative outside,
+  // 0 on it. Only the sign is exact
+  inline double in_sphere(const Vector& a, const Vector& b, const Vector& c, const Vector& d, const Vector& e){
+    constexpr double err_bound = (16 + 224 * epsilon) * epsilon;
+    stats.in_sphere_calls++;
+
+    const double aex = a[0] - e[0], aey = a[1] - e[1], aez = a[2] - e[2];
+    const double bex = b[0] - e[0], bey = b[1] - e[1], bez = b[2] - e[2];
+    const double cex = c[0] - e[0], cey = c[1] - e[1], cez = c[2] - e[2];
+    const double dex = d[0] - e[0], dey = d[1] - e[1], dez = d[2] - e[2];
+
+    const double aexbey = aex * bey, bexaey = bex * aey;
+    const double bexcey = bex * cey, cexbey = cex * bey;
+    const double cexdey = cex * dey, dexcey = dex * cey;
+    const double dexaey = dex * aey, aexdey = aex * dey;
+    const double aexcey = aex * cey, cexaey = cex * aey;
+    const double bexdey = bex * dey, dexbey = dex * bey;
+
+    const double ab = aexbey - bexaey, bc = bexcey - cexbey, cd = cexdey - dexcey;
+    const double da = dexaey - aexdey, ac = aexcey - cexaey, bd = bexdey - dexbey;
+
+    const double abc = aez * bc - bez * ac + cez * ab;
+    const double bcd = bez * cd - cez * bd + dez * bc;
+    const double cda = cez * da + dez * ac + aez * cd;
+    const double dab = dez * ab + aez * bd + bez * da;
+
+    const double a_lift = aex * aex + aey * aey + aez * aez;
+    const double b_lift = bex * bex + bey * bey + bez * bez;
+    const double c_lift = cex * cex + cey * cey + cez * cez;
+    const double d_lift = dex * dex + dey * dey + dez * dez;
+
+    // Its sign is the opposite of ours, as for orient_3d
+    const double det = (d_lift * abc - c_lift * dab) + (b_lift * cda - a_lift * bcd);
+
+    const double az = std::abs(aez), bz = std::abs(bez), cz = std::abs(cez), dz = std::abs(dez);
+    const double p_ab = std::abs(aexbey) + std::abs(bexaey), p_bc = std::abs(bexcey) + std::abs(cexbey);
+    const double p_cd = std::abs(cexdey) + std::abs(dexcey), p_da = std::abs(dexaey) + std::abs(aexdey);
+    const double p_ac = std::abs(aexcey) + std::abs(cexaey), p_bd = std::abs(bexdey) + std::abs(dexbey);
+    const double permanent = (p_cd * bz + p_bd * cz + p_bc * dz) * a_lift
+                           + (p_da * cz + p_ac * dz + p_cd * az) * b_lift
+                           + (p_ab * dz + p_bd * az + p_da * bz) * c_lift
+                           + (p_bc * az + p_ac * bz + p_ab * cz) * d_lift;
+
+    if (std::abs(det) > err_bound * permanent) return -det;
+
+    stats.in_sphere_exact++;
+    return in_sphere_exact(a, b, c, d, e);
+  }
+}
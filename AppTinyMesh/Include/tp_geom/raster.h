@@ -0,0 +1,32 @@
+#pragma once
+#include "mesh.h"
+#include <box.h>
+#include <ostream>
+
+/** Regular grid of samples of the z of a triangulation (DEM).
+  * Pixel (col, row) is sampled at its center, row 0 is along the largest y of the bounds
+  */
+struct Raster {
+  enum class Interpolation {
+    Linear, // Plane of the triangle holding the pixel
+    Sibson  // Natural neighbours : weights of the Voronoi areas a sample at the pixel would take to its neighbours
+  };
+
+  size_t width = 0, height = 0;
+  Box bounds;
+  std::vector<float> values; // Row by row, NaN outside of the hull
+
+  float at(size_t col, size_t row) const { return values[row * width + col]; }
+  Vector pixel_center(size_t col, size_t row) const;
+
+  // Raw float32 values, row by row
+  void write(std::ostream& stream) const;
+};
+
+namespace TriMeshAlgorithm {
+  // Each triangle is scan converted into the pixels whose center it holds, there is no point location.
+  // The grid is cut in tiles rasterized in parallel, each tile only goes through the triangles over it.
+  // Sibson needs a Delaunay mesh, it falls back to linear on the hull edges
+  Raster rasterize(const TriangleMesh& mesh, const Box& bounds, size_t width, size_t height,
+                   Raster::Interpolation mode = Raster::Interpolation::Linear);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "mesh.h"
+#include <array>
+#include <vector>
+
+/** Stitch shared by DelaunayTriangulation2D::build_parallel and TiledDelaunay2D. The cloud is triangulated
+  * by parts, a triangle of a part whose circumcircle only covers points the part inserted is Delaunay for the
+  * whole cloud and is kept. The holes left between the kept triangles are filled with the triangles of a
+  * second triangulation of the seam, made of the vertices around the holes.
+  */
+namespace SeamStitch {
+  struct Circle {
+    double x = 0, y = 0, r = 0;
+
+    bool inside(double min_x, double min_y, double max_x, double max_y) const {
+      return x - r > min_x && x + r < max_x && y - r > min_y && y + r < max_y;
+    }
+  };
+
+  // Circumcircle of the xy projection of a CCW triangle, false if the triangle is flat or CW.
+  // Its radius is slightly bigger, a false negative only makes the seam a bit larger
+  bool circumcircle(const std::array<Vector, 3>& tri, Circle& circle);
+
+  // out holds the vertices and the kept triangles, linked together. Their edges without a kept triangle on the
+  // other side (size_t_max) bound the holes, they must be edges of the seam. The seam triangles covering the kept
+  // areas are dropped, the others are appended to out and linked, then vertex_to_triangle is set.
+  // Returns false if the seam doesn't fit the holes (cocircular points split differently by a part and the seam)
+  bool fill_holes(TriangleMesh& out, TriangleMesh& seam, const std::vector<size_t>& seam_to_global,
+                  const std::vector<size_t>& global_to_seam);
+}
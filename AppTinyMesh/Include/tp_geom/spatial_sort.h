@@ -0,0 +1,32 @@
+#pragma once
+#include "utils.h"
+#include "vertex_store.h"
+#include <vector>
+#include <cstdint>
+
+/** Insertion orders that keep consecutive points close to each other,
+  * so that each walk of the point locator starts near its target.
+  */
+namespace SpatialSort {
+  // Index of the cell (x, y) on a Hilbert curve of 2^16 x 2^16 cells
+  uint32_t hilbert_index_2d(uint32_t x, uint32_t y);
+
+  // Hilbert key of every point, quantized on the xy bounding box of the cloud
+  std::vector<uint32_t> hilbert_keys(const std::vector<Vector>& points);
+
+  // Permutation of the points sorted along the Hilbert curve
+  std::vector<size_t> hilbert_order(const std::vector<Vector>& points);
+
+  // Same from the coordinates stored by axis, only x and y are read
+  template <typename Real> std::vector<uint32_t> hilbert_keys(const VertexStore<Real>& points);
+  template <typename Real> std::vector<size_t> hilbert_order(const VertexStore<Real>& points);
+
+  // Biased randomized insertion order : random rounds of doubling size, each one sorted along the Hilbert curve
+  std::vector<size_t> brio_order(const std::vector<Vector>& points, unsigned int seed = 0);
+
+  // Same in 3d, on a Hilbert curve of 2^10 x 2^10 x 2^10 cells
+  uint32_t hilbert_index_3d(uint32_t x, uint32_t y, uint32_t z);
+  std::vector<uint32_t> hilbert_keys_3d(const std::vector<Vector>& points);
+  std::vector<size_t> hilbert_order_3d(const std::vector<Vector>& points);
+  std::vector<size_t> brio_order_3d(const std::vector<Vector>& points, unsigned int seed = 0);
+}
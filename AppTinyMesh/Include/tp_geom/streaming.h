@@ -0,0 +1,107 @@
+#pragma once
+#include "mesh.h"
+#include "tp_geom/triangulation.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+/** Delaunay triangulation of clouds that don't fit in memory, by spatial finalization (Isenburg et al. 2006).
+  * finalize reads the cloud (text format of load_point_cloud) and writes a point stream : the xy bounds are cut
+  * in a grid of cells, and a cell is finalized in the stream right after its last point, no later point lies in it.
+  * triangulate reads this stream and inserts the points one by one. A triangle whose circumcircle only covers
+  * finalized cells can't be changed by a later point, it is written out and removed from memory, a vertex is
+  * written before its first triangle and released after its last one.
+  * Memory is bounded by the front between finalized and open cells, which stays small when the points of
+  * the cloud are spatially coherent (scan lines of a LiDAR, tiles). On a shuffled cloud every cell stays open
+  * until the end and the whole mesh is kept.
+  */
+struct StreamingDelaunay2D : public TriangulationBase {
+  // Start of a point stream, then records : 'p' and x, y, z as doubles, or 'c' and a cell id (uint64_t)
+  struct StreamHeader {
+    uint64_t point_count = 0;
+    uint64_t grid_size = 1; // The bounds are cut in grid_size x grid_size cells, row by row from the min corner
+    double x_min = 0, y_min = 0, x_max = 0, y_max = 0;
+
+    size_t cell_of(double x, double y) const;
+  };
+
+  struct FinalizeStats {
+    size_t points = 0;
+    size_t cells = 0;
+    size_t max_open_cells = 0; // Cells that had points but not all of them yet
+  };
+
+  struct Stats {
+    size_t points = 0;
+    size_t duplicates = 0; // Points on an existing vertex, skipped
+    size_t triangles = 0;  // Written
+    size_t vertices = 0;   // Written
+    size_t max_triangles = 0; // Largest number of triangles in memory, hull triangles included
+    size_t max_vertices = 0;
+    size_t scans = 0;      // Walks blocked by written triangles, the point was located by a scan of the front
+  };
+
+  // Reads the cloud 3 times : bounds, points per cell, then the stream. The cells hold ~points_per_cell points
+  static FinalizeStats finalize(std::istream& cloud, std::ostream& stream, size_t points_per_cell = 64);
+
+  // Writes the mesh as records : 'v' and x, y, z as doubles (the vertices are numbered in this order from 0),
+  // 'f' and 3 vertex ids as uint64_t (CCW), 'x' and a vertex id after its last triangle
+  Stats triangulate(std::istream& stream, std::ostream& out);
+private:
+  StreamHeader header;
+  double cell_width = 1, cell_height = 1;
+  Stats stats;
+  std::ostream* out = nullptr;
+
+  // Cells : finalized flag, open cells per block of block_size x block_size cells,
+  // first triangle waiting for the cell to be finalized, last vertex inserted in the cell
+  std::vector<char> finalized;
+  std::vector<uint32_t> block_open;
+  size_t block_count = 1;
+  std::vector<size_t> waiting_head;
+  std::vector<size_t> cell_vertex;
+
+  // Per triangle : doubly linked list of the triangles waiting for the same cell
+  std::vector<size_t> waiting_prev, waiting_next, waiting_cell;
+  // Per vertex : id in the output (size_t_max until written), triangles in memory around it
+  std::vector<size_t> output_id;
+  std::vector<uint32_t> live_tris;
+
+  size_t locate_hint = size_t_max;
+  uint32_t coin = 0x9E3779B9u;
+
+  // Points and cells read before the first triangle could be made, the first points may be aligned
+  std::vector<Vector> pending_points;
+  std::vector<size_t> pending_cells;
+
+  // Buffers of an insertion
+  struct StarTri { size_t a, b, outer, slot; };
+  std::vector<size_t> cavity;
+  std::vector<size_t> cavity_rejected;
+  std::vector<char> cavity_state;
+  std::vector<StarTri> star;
+  std::vector<std::pair<size_t, size_t>> star_by_a;
+
+  void reset();
+  void add_point(const Vector& point);
+  void finalize_cell(size_t cell);
+  bool init_first_triangle();
+
+  // Triangle in conflict with the point, size_t_max if the point is on a vertex
+  size_t locate(const Vector& point);
+  size_t walk(const Vector& point, size_t tri_id);
+  bool in_conflict(size_t tri_id, const Vector& point) const;
+  // Bowyer-Watson insertion from a triangle in conflict, false if the point is on a vertex
+  bool insert(const Vector& point, size_t seed);
+
+  size_t new_vertex(const Vector& point);
+  size_t new_triangle();
+  void release_triangle(size_t tri_id);
+  // Waits for the first open cell under the circumcircle, writes the triangle if there is none
+  void schedule(size_t tri_id);
+  void wait(size_t tri_id, size_t cell);
+  size_t first_open_cell(size_t tri_id) const;
+  void unlink_waiting(size_t tri_id);
+  void write_triangle(size_t tri_id);
+  void flush();
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include "mesh.h"
+#include <array>
+#include <vector>
+
+// Tetrahedron : face i is the one opposite to vertex i, opposite_tet[i] is the tet on the other side.
+// Its vertices are positive (Predicates::orient_3d > 0). The ids are stored as MeshIndex, a tet is then
+// 32 bytes, two per cache line
+struct MTet {
+  using Id = StoredIndex<MeshIndex>;
+
+  std::array<Id, 4> vertices{size_t_max, size_t_max, size_t_max, size_t_max};
+  std::array<Id, 4> opposite_tet{size_t_max, size_t_max, size_t_max, size_t_max};
+
+  MTet() {}
+  MTet(const std::array<size_t, 4>& v): vertices{v[0], v[1], v[2], v[3]} {}
+
+  LocalId<4> local_id_of(size_t v) const {
+    for (int i = 0; i < 4; i++)
+      if (vertices[i] == v) return i;
+    return LocalId<4>::make_invalid();
+  }
+  // Face shared with a neighbour, invalid if it isn't one
+  LocalId<4> face_towards(size_t tet_id) const {
+    for (int i = 0; i < 4; i++)
+      if (opposite_tet[i] == tet_id) return i;
+    return LocalId<4>::make_invalid();
+  }
+  bool is_infinite() const;
+  // Slot of a removed tet, waiting in the free list of the mesh
+  bool is_free() const { return vertices[0] == size_t_max; }
+};
+
+/** Tetrahedral mesh closed by an infinite vertex, as TriangleMesh in 2d : each face of the hull has an
+  * infinite tet on its other side, made of the face and the infinite vertex. With the infinite vertex replaced
+  * by a point beyond the face the infinite tet is positive too.
+  */
+struct TetMesh {
+  std::vector<Vector> vertices;
+  std::vector<size_t> vertex_to_tet;
+  std::vector<MTet> tets;
+
+  // Slots of the removed tets, the next additions reuse them (last freed first)
+  std::vector<size_t> free_tets;
+
+  static constexpr size_t infinite_point = 0;
+  static constexpr size_t v_start_offset = infinite_point + 1;
+
+  TetMesh();
+
+  // Throws std::length_error past the ids MeshIndex can hold, as BasicTriangleMesh::check_size
+  static void check_size(size_t vertex_count, size_t tet_count);
+  size_t add_point(const Vector& point);
+  // Id of an empty tet, the caller fills it
+  size_t add_tet();
+  void remove_tet(size_t tet_id);
+  // Vertex without tet, e.g. a duplicate point or a point not inserted yet
+  bool is_free_vertex(size_t vertex) const { return vertex != infinite_point && vertex_to_tet[vertex] == size_t_max; }
+
+  std::array<Vector, 4> get_vertices(const MTet& tet) const {
+    return { vertices[tet.vertices[0]], vertices[tet.vertices[1]], vertices[tet.vertices[2]], vertices[tet.vertices[3]] };
+  }
+  size_t finite_tet_count() const;
+  void clear();
+};
+
+inline bool MTet::is_infinite() const {
+  return local_id_of(TetMesh::infinite_point).is_valid();
+}
+
+// Vertices, links and orientations of the tets, only in debug
+void assert_tet_mesh_valid(const TetMesh& m);
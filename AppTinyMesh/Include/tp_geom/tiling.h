@@ -0,0 +1,112 @@
+#pragma once
+#include "mesh.h"
+#include "tp_geom/delaunay.h"
+#include "tp_geom/triangulation.h"
+#include <box.h>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+/** Grid of fixed tiles over the xy bounds of a cloud. Each tile owns its core and is triangulated with the
+  * points of its buffer, the core grown by the margin. The points out of the bounds are clamped to them.
+  */
+struct TileManifest {
+  struct Tile {
+    Box core;
+    Box buffer;
+  };
+
+  Box bounds;
+  size_t columns = 1, rows = 1;
+  double margin = 0;
+
+  TileManifest() {}
+  // Tiles of about tile_size x tile_size, the margin should hold a few points on each side
+  TileManifest(const Box& bounds, double tile_size, double margin);
+
+  size_t size() const { return columns * rows; }
+  // Tiles are numbered row by row from the min corner
+  Tile tile(size_t id) const;
+  size_t tile_of(double x, double y) const;
+  // Tiles whose buffer meets the area : the points changed in the area only change these tiles
+  std::vector<size_t> tiles_over(const Box& area) const;
+  // Ids of the points in the buffer of a tile, increasing
+  std::vector<size_t> buffer_points(const std::vector<Vector>& points, size_t id) const;
+
+  // Text : columns, rows and margin, the bounds, then a line per tile with its core and buffer (only informative)
+  void write(std::ostream& stream) const;
+  // Returns false and leaves result untouched if the text is cut or the grid is invalid (no tile, negative margin)
+  static bool read(std::istream& stream, TileManifest& result);
+};
+
+/** Delaunay triangulation of a large cloud by independent tiles, a lighter alternative to StreamingDelaunay2D
+  * when the cloud fits in memory but the work should be farmed out (threads or processes).
+  * A tile triangulates its buffer and keeps the triangles whose circumcenter is in its core and whose
+  * circumcircle is inside its buffer : all the points that could be in the circle were inserted, the triangle is
+  * Delaunay for the whole cloud, and no other tile keeps it. The points not surrounded by kept triangles make
+  * the seam, triangulated again in one piece to fill the holes between the kept areas (as build_parallel).
+  * A tile only depends on the points of its buffer, after a change only the tiles over it are run again.
+  */
+struct TiledDelaunay2D : public TriangulationBase {
+  using Kernel = DelaunayTriangulation2D::Kernel;
+
+  // Result of a tile : its kept triangles, vertex i + 1 is points[i] (as in the stitched mesh),
+  // the opposite triangles are in the same list, size_t_max when the tile didn't keep them
+  struct TileTriangulation {
+    size_t tile = 0;
+    std::vector<MTriangle> triangles;
+
+    // Raw uint64_t : tile, triangle count, then the 3 vertices and 3 opposite triangles of each triangle
+    void write(std::ostream& stream) const;
+    static bool read(std::istream& stream, TileTriangulation& result);
+  };
+
+  struct Stats {
+    size_t tiles_run = 0;      // By the last build or update
+    size_t kept = 0;           // Triangles kept from the tiles
+    size_t seam_points = 0;
+    size_t seam_triangles = 0; // Triangles of the seam filling the holes, hull triangles included
+    bool fallback = false;     // The seam couldn't be stitched, the whole cloud was triangulated at once
+  };
+
+  TiledDelaunay2D(const TileManifest& manifest, Kernel kernel = Kernel::Flips): manifest(manifest), kernel(kernel) {}
+
+  // Job of a tile, e.g. in another process. Only reads the points in the buffer of the tile
+  static TileTriangulation triangulate_tile(const std::vector<Vector>& points, const TileManifest& manifest,
+                                            size_t tile, Kernel kernel = Kernel::Flips);
+
+  // Triangulates every tile in parallel then stitches them. Returns the vertex id given to each input point,
+  // i + 1 unless the stitch failed (cocircular points split differently by the tiles and the seam).
+  // A copy of an earlier point gets the id of the first copy, its own vertex is free
+  std::vector<size_t> build(const std::vector<Vector>& points);
+  // Same as build, only the dirty tiles are triangulated again (see TileManifest::tiles_over with the old and
+  // new places of the changed points). The other points keep their index, points can be moved or appended
+  std::vector<size_t> update(const std::vector<Vector>& points, const std::vector<size_t>& dirty);
+  // Stitches the tiles triangulated elsewhere, one per tile of the manifest
+  std::vector<size_t> stitch(const std::vector<Vector>& points, std::vector<TileTriangulation> results);
+
+  const TileManifest& get_manifest() const { return manifest; }
+  const std::vector<TileTriangulation>& get_tiles() const { return tiles; }
+  const Stats& get_stats() const { return stats; }
+private:
+  TileManifest manifest;
+  Kernel kernel;
+  std::vector<TileTriangulation> tiles;
+  Stats stats;
+
+  std::vector<size_t> stitch_or_fallback(const std::vector<Vector>& points);
+  bool stitch_tiles(const std::vector<Vector>& points, std::vector<size_t>& ids);
+};
+
+namespace TriMeshAlgorithm {
+  struct SeamCheck {
+    size_t edges = 0; // Seam edges checked
+    std::vector<std::pair<size_t, LocalId<3>>> failures; // Non Delaunay ones, as (triangle, edge)
+
+    bool valid() const { return failures.empty(); }
+  };
+
+  // Checks with is_edge_delaunay_2d the edges of a tiled triangulation that no single tile vouches for :
+  // edges of a triangle no tile would keep, or between triangles kept by different tiles
+  SeamCheck verify_seams(const TriangleMesh& mesh, const TileManifest& manifest);
+}
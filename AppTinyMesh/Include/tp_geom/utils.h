@@ -1,6 +1,7 @@
 #pragma once
 #include <cassert>
 #include <mathematics.h>
+#include "predicates.h"
 #include <math.h>
 #include <array>
 #include <variant>
@@ -15,6 +16,11 @@ inline float angle_between(Vector v1, Vector v2){
   return acos(Normalized(v1) * Normalized(v2));
 }
 
+inline double squared_distance_2d(const Vector& a, const Vector& b){
+  const double dx = a[0] - b[0], dy = a[1] - b[1];
+  return dx * dx + dy * dy;
+}
+
 enum class TriOrient : char {
   CW = -1,
   Flat = 0,
@@ -22,22 +28,44 @@ enum class TriOrient : char {
 };
 
 inline TriOrient orientation_2d(const std::array<Vector, 3>& tri){
-  const Vector u = tri[1] - tri[0]; 
-  const Vector v = tri[2] - tri[0]; 
-
-  // Ensure a good estimation of the zero value
-  // const double max_error = std::max(std::max(u[0], u[1]), std::max(v[0], v[1])); 
-  // const double epsilon = std::numeric_limits<double>::epsilon() * max_error * 64; 
+  const double orientation = Predicates::orient_2d(tri[0], tri[1], tri[2]);
 
-  const double orientation = u[0] * v[1] - u[1] * v[0];
-  const double epsilon = std::numeric_limits<double>::epsilon() * std::abs(orientation) * 16; 
-
-  if (orientation > -epsilon && orientation < epsilon)
+  if (orientation == 0)
     return TriOrient::Flat; 
 
   return orientation > 0 ? TriOrient::CCW : TriOrient::CW;
 }
 
+// Positive if point is inside the circumcircle of the CCW triangle, negative outside, 0 on the circle
+inline double in_circle_2d(const std::array<Vector, 3>& tri, const Vector& point){
+  return Predicates::in_circle(tri[0], tri[1], tri[2], point);
+}
+
+// Center of the circumcircle of the xy projection, not finite if the triangle is flat
+inline Vector circumcenter_2d(const std::array<Vector, 3>& tri){
+  const double bx = tri[1][0] - tri[0][0], by = tri[1][1] - tri[0][1];
+  const double cx = tri[2][0] - tri[0][0], cy = tri[2][1] - tri[0][1];
+  const double d = 2 * (bx * cy - by * cx);
+  const double b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+  return Vector(tri[0][0] + (cy * b2 - by * c2) / d, tri[0][1] + (bx * c2 - cx * b2) / d, 0);
+}
+
+// Barycentric coordinates of point in the xy projection of the triangle
+inline std::array<double, 3> barycentric_2d(const std::array<Vector, 3>& tri, const Vector& point){
+  const auto cross = [](const Vector& a, const Vector& b, const Vector& c){
+    return (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+  };
+
+  const double area = cross(tri[0], tri[1], tri[2]);
+  if (area == 0) return { 1, 0, 0 };
+
+  return {
+    cross(point, tri[1], tri[2]) / area,
+    cross(tri[0], point, tri[2]) / area,
+    cross(tri[0], tri[1], point) / area
+  };
+}
+
 template <unsigned int k>
 struct LocalId {
   LocalId(): index(0) {}
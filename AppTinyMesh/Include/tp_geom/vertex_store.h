@@ -0,0 +1,57 @@
+#pragma once
+#include "utils.h"
+#include <array>
+#include <new>
+#include <vector>
+
+// Allocator of blocks starting on an Align bytes boundary
+template <typename T, size_t Align>
+struct AlignedAllocator {
+  using value_type = T;
+  template <typename U> struct rebind { using other = AlignedAllocator<U, Align>; };
+
+  AlignedAllocator() = default;
+  template <typename U> AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+  T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align))); }
+  void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(Align)); }
+
+  bool operator==(const AlignedAllocator&) const { return true; }
+  bool operator!=(const AlignedAllocator&) const { return false; }
+};
+
+/** Coordinates of vertices stored axis by axis (structure of arrays), each array on a cache line boundary.
+  * A pass over the xy plane then reads nothing else, and its loops vectorize.
+  * Real is the storage : float halves the memory and is what the renderer uploads, double keeps the
+  * exact coordinates the predicates work on. Without z (elevation disabled) the vertices read at z = 0.
+  * The ids are the ones of the source, the infinite vertex of a mesh included.
+  */
+template <typename Real>
+struct VertexStore {
+  using Array = std::vector<Real, AlignedAllocator<Real, 64>>;
+  Array x, y, z;
+
+  VertexStore(bool with_z = true): with_z(with_z) {}
+  VertexStore(const std::vector<Vector>& points, bool with_z = true);
+
+  size_t size() const { return x.size(); }
+  bool has_z() const { return with_z; }
+  void reserve(size_t n);
+  void resize(size_t n);
+  void clear();
+
+  size_t push_back(const Vector& point);
+  void set(size_t id, const Vector& point);
+  Vector get(size_t id) const { return Vector(x[id], y[id], with_z ? z[id] : 0); }
+  std::vector<Vector> to_vectors() const;
+
+  // xy, or xyz, of each vertex one after the other : the layout of a vertex buffer
+  std::vector<Real> interleaved() const;
+  // min x, min y, max x, max y of the vertices [begin, size())
+  std::array<Real, 4> planar_bounds(size_t begin = 0) const;
+private:
+  bool with_z;
+};
+
+using VertexStoreF = VertexStore<float>;
+using VertexStoreD = VertexStore<double>;
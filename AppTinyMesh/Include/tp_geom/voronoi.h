@@ -0,0 +1,40 @@
+#pragma once
+#include "mesh.h"
+#include <box.h>
+#include <ostream>
+
+/** Voronoi diagram of the vertices of a Delaunay triangulation, in the xy plane.
+  * The cells are stored in compressed rows (CSR) : one offset per vertex and a single array of corner ids,
+  * the corners are shared by the cells around them.
+  */
+struct VoronoiDiagram {
+  // Corner t is the circumcenter of triangle t (NaN for the infinite and the free triangles),
+  // the corners made by the clipping come after
+  std::vector<double> x, y;
+
+  // Cell of vertex v, CCW : cell_corners[cell_offsets[v], cell_offsets[v + 1]).
+  // The cells of the infinite vertex and of the free vertices are empty
+  std::vector<size_t> cell_offsets;
+  std::vector<size_t> cell_corners;
+
+  size_t cell_count() const { return cell_offsets.empty() ? 0 : cell_offsets.size() - 1; }
+  size_t cell_size(size_t v) const { return cell_offsets[v + 1] - cell_offsets[v]; }
+  const size_t* cell_begin(size_t v) const { return cell_corners.data() + cell_offsets[v]; }
+
+  double cell_area(size_t v) const;
+  std::vector<double> cell_areas() const;
+
+  // Raw little endian arrays, each one after its size : x, y, cell_offsets, cell_corners
+  void write(std::ostream& stream) const;
+};
+
+namespace TriMeshAlgorithm {
+  // Circumcenter of every triangle, NaN for the infinite and the free triangles
+  void circumcenters(const TriangleMesh& mesh, std::vector<double>& x, std::vector<double>& y);
+
+  // The cells of the hull vertices are unbounded, every cell is clipped to the xy rectangle of the box.
+  // The mesh must be Delaunay, on a constrained mesh the cells of the ends of the constraints overlap
+  VoronoiDiagram voronoi(const TriangleMesh& mesh, const Box& bounds);
+  // Clipped to the bounding box of the vertices
+  VoronoiDiagram voronoi(const TriangleMesh& mesh);
+}
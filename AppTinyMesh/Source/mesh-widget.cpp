@@ -1,6 +1,7 @@
 #include "realtime.h"
 
 #include "meshcolor.h"
+#include "tp_geom/vertex_store.h"
 
 #include <iostream>
 
@@ -29,6 +30,23 @@ MeshWidget::MeshGL::MeshGL()
     SetFrame(Vector::Null);
 }
 
+/*!
+\brief Positions of the triangle corners, in the layout of the vertex buffer.
+
+A flat mesh (elevation disabled, every z at 0) is stored without z : its buffer holds xy only, and the shader reads z = 0.
+*/
+static VertexStoreF CornerPositions(const Mesh& mesh, const std::vector<int>& vertexIndexes)
+{
+    const Box box = mesh.GetBox();
+    const bool flat = box[0][2] == 0 && box[1][2] == 0;
+
+    VertexStoreF positions(!flat);
+    positions.reserve(vertexIndexes.size());
+    for (int indexVertex : vertexIndexes)
+        positions.push_back(mesh.Vertex(indexVertex));
+    return positions;
+}
+
 /*!
 \brief Constructor from a Mesh and a frame scaled.
 */
@@ -44,18 +62,14 @@ MeshWidget::MeshGL::MeshGL(const Mesh& mesh, const Vector& position) : MeshGL()
 
     int nbVertex = int(vertexIndexes.size());
     int singleBufferSize = nbVertex * 3;
-    float* vertices = new float[singleBufferSize];
+    const VertexStoreF positions = CornerPositions(mesh, vertexIndexes);
+    const std::vector<float> vertices = positions.interleaved();
+    const int vertexSize = positions.has_z() ? 3 : 2;
     float* normals = new float[singleBufferSize];
     for (int i = 0; i < nbVertex; i++)
     {
-        int indexVertex = vertexIndexes[i];
         int indexNormal = normalIndexes[i];
 
-        Vector vertex = mesh.Vertex(indexVertex);
-        vertices[i * 3 + 0] = float(vertex[0]);
-        vertices[i * 3 + 1] = float(vertex[1]);
-        vertices[i * 3 + 2] = float(vertex[2]);
-
         Vector normal = mesh.Normal(indexNormal);
         normals[i * 3 + 0] = float(normal[0]);
         normals[i * 3 + 1] = float(normal[1]);
@@ -77,7 +91,7 @@ MeshWidget::MeshGL::MeshGL(const Mesh& mesh, const Vector& position) : MeshGL()
 
 
     glBindVertexArray(vao);
-    size_t fullSize = sizeof(float) * singleBufferSize
+    size_t fullSize = sizeof(float) * vertices.size()
             + sizeof(float) * singleBufferSize;
     glBindBuffer(GL_ARRAY_BUFFER, fullBuffer);
     glBufferData(GL_ARRAY_BUFFER, fullSize, nullptr, GL_STATIC_DRAW);
@@ -85,9 +99,9 @@ MeshWidget::MeshGL::MeshGL(const Mesh& mesh, const Vector& position) : MeshGL()
     // Vertices(0)
     size_t size = 0;
     size_t offset = 0;
-    size = sizeof(float) * singleBufferSize;
-    glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void*)offset);
+    size = sizeof(float) * vertices.size();
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices.data());
+    glVertexAttribPointer(0, vertexSize, GL_FLOAT, GL_FALSE, 0, (const void*)offset);
     glEnableVertexAttribArray(0);
 
     // Normals(1)
@@ -103,7 +117,6 @@ MeshWidget::MeshGL::MeshGL(const Mesh& mesh, const Vector& position) : MeshGL()
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(int) * nbVertex, indices, GL_STATIC_DRAW);
 
     // Free data
-    delete[] vertices;
     delete[] normals;
     delete[] indices;
 }
@@ -124,20 +137,16 @@ MeshWidget::MeshGL::MeshGL(const MeshColor& mesh, const Vector& fr) : MeshGL()
 
     int nbVertex = int(vertexIndexes.size());
     int singleBufferSize = nbVertex * 3;
-    float* vertices = new float[singleBufferSize];
+    const VertexStoreF positions = CornerPositions(mesh, vertexIndexes);
+    const std::vector<float> vertices = positions.interleaved();
+    const int vertexSize = positions.has_z() ? 3 : 2;
     float* normals = new float[singleBufferSize];
     float* colors = new float[singleBufferSize];
     for (int i = 0; i < nbVertex; i++)
     {
-        int indexVertex = vertexIndexes[i];
         int indexNormal = normalIndexes[i];
         int indexColor = colorIndexes[i];
 
-        Vector vertex = mesh.Vertex(indexVertex);
-        vertices[i * 3 + 0] = float(vertex[0]);
-        vertices[i * 3 + 1] = float(vertex[1]);
-        vertices[i * 3 + 2] = float(vertex[2]);
-
         Vector normal = mesh.Normal(indexNormal);
         normals[i * 3 + 0] = float(normal[0]);
         normals[i * 3 + 1] = float(normal[1]);
@@ -164,7 +173,7 @@ MeshWidget::MeshGL::MeshGL(const MeshColor& mesh, const Vector& fr) : MeshGL()
 
     glBindVertexArray(vao);
     size_t fullSize =
-            sizeof(float) * singleBufferSize	// Vertices
+            sizeof(float) * vertices.size()	// Vertices
             + sizeof(float) * singleBufferSize	// Normals
             + sizeof(float) * singleBufferSize;	// Colors
     glBindBuffer(GL_ARRAY_BUFFER, fullBuffer);
@@ -173,9 +182,9 @@ MeshWidget::MeshGL::MeshGL(const MeshColor& mesh, const Vector& fr) : MeshGL()
     // Vertices(0)
     size_t size = 0;
     size_t offset = 0;
-    size = sizeof(float) * singleBufferSize;
-    glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void*)offset);
+    size = sizeof(float) * vertices.size();
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices.data());
+    glVertexAttribPointer(0, vertexSize, GL_FLOAT, GL_FALSE, 0, (const void*)offset);
     glEnableVertexAttribArray(0);
 
     // Normals(1)
@@ -198,7 +207,6 @@ MeshWidget::MeshGL::MeshGL(const MeshColor& mesh, const Vector& fr) : MeshGL()
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(int) * nbVertex, indices, GL_STATIC_DRAW);
 
     // Free data
-    delete[] vertices;
     delete[] normals;
     delete[] colors;
     delete[] indices;
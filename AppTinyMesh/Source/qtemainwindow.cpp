@@ -78,6 +78,8 @@ MeshColor convertToQtMesh(const TriangleMesh& triMesh){
 
 	size_t n = 0;
 	for (auto& tri : triMesh.triangles){
+    if (tri.is_free()) continue;
+
     indices.push_back(tri.vertices[0]);
     indices.push_back(tri.vertices[1]);
 	  indices.push_back(tri.vertices[2]);
@@ -151,18 +153,18 @@ void MainWindow::triangulationNext() {
 
 void MainWindow::loadNaiveToDelaunay() {
 	mode = View::TRIANGULATION;
-  const auto points = load_point_cloud(uiw->tri_path->text().toStdString());
+  auto points = load_point_cloud(uiw->tri_path->text().toStdString());
   Triangulation2D tri;
 
-  for (size_t i = 0; i < points.size(); i++){
-    Vector p = points[i] / 1000;
+  for (Vector& p : points){
+    p = p / 1000;
 
     if (!uiw->tri_elevate->isChecked())
       p[2] = 0;
-
-    tri.add_point(p);
   }
 
+  tri.build(points);
+
   const auto mesh = TriMeshAlgorithm::to_delaunay(tri);
 
   meshColor = convertToQtMesh(mesh);
@@ -185,16 +187,27 @@ void MainWindow::loadTriangulation() {
     del = std::make_unique<Triangulation2D>();
 
   loaded = load_point_cloud(uiw->tri_path->text().toStdString());
-  
-  const size_t size = uiw->tri_load_first->isChecked() ? 3 : loaded.size();
 
-  for (last = 0; last < size; last++){
-    Vector p = loaded[last] / 1000;
+  if (uiw->tri_load_first->isChecked()){
+    for (last = 0; last < 3; last++){
+      Vector p = loaded[last] / 1000;
 
-    if (!uiw->tri_elevate->isChecked())
-      p[2] = 0;
+      if (!uiw->tri_elevate->isChecked())
+        p[2] = 0;
 
-    del->add_point(p);
+      del->add_point(p);
+    }
+  } else {
+    std::vector<Vector> points = loaded;
+    for (Vector& p : points){
+      p = p / 1000;
+
+      if (!uiw->tri_elevate->isChecked())
+        p[2] = 0;
+    }
+
+    del->build(points);
+    last = loaded.size();
   }
 
   meshColor = convertToQtMesh(del->get_mesh());
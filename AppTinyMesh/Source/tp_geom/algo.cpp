@@ -1,29 +1,36 @@
 #include "tp_geom/algo.h"
 
+namespace {
+  // The neighbour of old_tri across old_edge becomes the one of tri_id across new_edge, both ways
+  void relink(TriangleMesh& mesh, const MTriangle& old_tri, LocalId<3> old_edge, size_t tri_id, LocalId<3> new_edge){
+    const size_t outer = old_tri.opposite_triangle[old_edge];
+    mesh.link(tri_id, new_edge, outer, outer == size_t_max ? LocalId<3>() : mesh.opposite_edge(old_tri, old_edge));
+  }
+}
+
 namespace TriMeshAlgorithm {
   SplitResult split_face(TriangleMesh& mesh, size_t tri_id, const Vector& point) {
     auto old_tri = mesh.triangles[tri_id];
     auto point_id = mesh.add_point(point);
 
-    auto old_tri_size = mesh.triangles.size();
-    mesh.triangles.resize( old_tri_size + 2 );
-    std::array<size_t, 3> new_tri_ids = {tri_id, old_tri_size, old_tri_size + 1};
+    const size_t new_tri_1 = mesh.add_triangle();
+    const size_t new_tri_2 = mesh.add_triangle();
+    std::array<size_t, 3> new_tri_ids = {tri_id, new_tri_1, new_tri_2};
 
     const auto make_triangle = [&](LocalId<3> i){
       size_t new_triangle_id = new_tri_ids[i];
       auto &new_triangle = mesh.triangles[new_triangle_id];
       auto edge = old_tri.get_edge(i);
-      
-      // Set the face on the opposite triangle
-      if (old_tri.opposite_triangle[i] != size_t_max){
-        auto &tri_adj = mesh.triangles[old_tri.opposite_triangle[i]];
-        auto adj_edge_id = tri_adj.find_edge(edge);
-        tri_adj.opposite_triangle[adj_edge_id] = new_triangle_id;
-      } 
 
       mesh.vertex_to_triangle[old_tri.vertices[i + 1]] = new_triangle_id;
       new_triangle.vertices = {point_id, edge.first, edge.second};
-      new_triangle.opposite_triangle = { old_tri.opposite_triangle[i], new_tri_ids[i + 1], new_tri_ids[i - 1] };
+      new_triangle.opposite_triangle[1] = { new_tri_ids[i + 1], 2 };
+      new_triangle.opposite_triangle[2] = { new_tri_ids[i - 1], 1 };
+
+      // Set the face on the opposite triangle
+      relink(mesh, old_tri, i, new_triangle_id, 0);
+      new_triangle.constraints = 0;
+      new_triangle.set_constrained(0, old_tri.is_constrained(i));
     };
 
     for (int i = 0; i < 3; i++)
@@ -48,60 +55,48 @@ namespace TriMeshAlgorithm {
       tri_1.vertices = { old_tri.vertices[edge_id - 1], old_tri.vertices[edge_id], point_id };
       tri_2.vertices = { old_tri.vertices[edge_id], old_tri.vertices[edge_id + 1], point_id };
 
-      tri_1.opposite_triangle = {
-        new_tri_id,
-        adj_tri_id,
-        old_tri.opposite_triangle[edge_id + 1]
-      };
-
-      tri_2.opposite_triangle = {
-        new_adj_tri_id,
-        tri_id,
-        old_tri.opposite_triangle[edge_id - 1]
-      };
-
-      // Remesh the opposite triangle on the edge edge+1,
-      // to point to link to this one instead if it exists
-      size_t adj_id = old_tri.opposite_triangle[edge_id - 1];
-      if (adj_id == size_t_max) return;
-
-      MTriangle& opposite_tri_2 = mesh.triangles[adj_id];
-      for (size_t& id : opposite_tri_2.opposite_triangle){
-        if (id == tri_id){
-          id = new_tri_id;
-          break;
-        }
-      }
+      // The half of the adjacent triangle along (p, v[edge_id - 1]) is its new one
+      mesh.link(tri_id, 0, new_tri_id, 1);
+      tri_1.opposite_triangle[1] = { new_adj_tri_id, 0 };
+      tri_2.opposite_triangle[0] = { adj_tri_id, 1 };
+
+      // Both outer edges moved, their neighbours are linked again
+      relink(mesh, old_tri, edge_id + 1, tri_id, 2);
+      relink(mesh, old_tri, edge_id - 1, new_tri_id, 2);
+
+      // The halves of a constrained edge stay constrained
+      const bool split_constrained = old_tri.is_constrained(edge_id);
+      tri_1.constraints = tri_2.constraints = 0;
+      tri_1.set_constrained(1, split_constrained);
+      tri_1.set_constrained(2, old_tri.is_constrained(edge_id + 1));
+      tri_2.set_constrained(0, split_constrained);
+      tri_2.set_constrained(2, old_tri.is_constrained(edge_id - 1));
+
+      // tri_1 doesn't hold v[edge_id + 1] anymore
+      mesh.vertex_to_triangle[old_tri.vertices[edge_id + 1]] = new_tri_id;
     }; // end remesh()
     
     MTriangle old_tri_1, old_tri_2;
     old_tri_1 = mesh.triangles[tri_id];
 
-    auto old_tri_count = mesh.triangles.size();
-    size_t new_size = old_tri_count + 1;
+    const size_t tri_split_id = mesh.add_triangle();
 
     size_t adj_tri_id = old_tri_1.opposite_triangle[edge_id]; 
     bool has_adj_tri = adj_tri_id != size_t_max; 
     size_t adj_tri_split_id = size_t_max;
+    LocalId<3> adj_edge_id;
 
     if (has_adj_tri){
       old_tri_2 = mesh.triangles[adj_tri_id];
-      adj_tri_split_id = new_size;
-      new_size++;
+      adj_tri_split_id = mesh.add_triangle();
+      adj_edge_id = mesh.opposite_edge(old_tri_1, edge_id);
     }
 
-    mesh.triangles.resize(new_size);
-
     mesh.vertex_to_triangle[point_id] = tri_id;
-    split_triangle(old_tri_1, edge_id, tri_id, old_tri_count, adj_tri_id, adj_tri_split_id);
+    split_triangle(old_tri_1, edge_id, tri_id, tri_split_id, adj_tri_id, adj_tri_split_id);
     
-    if (has_adj_tri){
-      MTriangle& adj_tri = mesh.triangles[adj_tri_id];
-      auto edge = old_tri_1.get_edge(edge_id);
-      size_t adj_edge_id = adj_tri.find_edge(edge);
-
-      split_triangle(old_tri_2, adj_edge_id, adj_tri_id, adj_tri_split_id, tri_id, old_tri_count);
-    }
+    if (has_adj_tri)
+      split_triangle(old_tri_2, adj_edge_id, adj_tri_id, adj_tri_split_id, tri_id, tri_split_id);
 
     assert_triangle_mesh_valid(mesh);
 
@@ -109,52 +104,60 @@ namespace TriMeshAlgorithm {
   }
 
   void edge_flip(TriangleMesh& mesh, const size_t tri_id_0, const LocalId<3> edge_id){
+    edge_flip_unchecked(mesh, tri_id_0, edge_id);
+    assert_triangle_mesh_valid(mesh);
+  }
+
+  void edge_flip_unchecked(TriangleMesh& mesh, const size_t tri_id_0, const LocalId<3> edge_id){
     MTriangle& tri_0 = mesh.triangles[tri_id_0];
     const size_t tri_id_1 = tri_0.opposite_triangle[edge_id]; 
     assert(tri_id_1 != size_t_max);
+    assert(!tri_0.is_constrained(edge_id));
 
-    MTriangle& tri_1 = mesh.triangles[tri_0.opposite_triangle[edge_id]];
+    MTriangle& tri_1 = mesh.triangles[tri_id_1];
+    const LocalId<3> o_edge_id = mesh.opposite_edge(tri_0, edge_id);
     MTriangle old_tri_0 = tri_0, old_tri_1 = tri_1;
 
-    const auto edge_pair = old_tri_0.get_edge(edge_id);
-    const LocalId<3> o_edge_id = old_tri_1.find_edge(edge_pair);
-
     // Peut changer selon l'orientation du triangle en face
     const LocalId<3> tri_0_e0 = edge_id + 1;
     const LocalId<3> tri_0_e1 = edge_id - 1;
-    const LocalId<3> tri_1_e0 = tri_1.local_id_of(edge_pair.first);
-    const LocalId<3> tri_1_e1 = tri_1.local_id_of(edge_pair.second);
+    // The shared edge goes the other way in tri_1
+    const LocalId<3> tri_1_e0 = o_edge_id + 2;
+    const LocalId<3> tri_1_e1 = o_edge_id + 1;
+    assert(old_tri_1.vertices[tri_1_e0] == old_tri_0.vertices[tri_0_e0]);
+    assert(old_tri_1.vertices[tri_1_e1] == old_tri_0.vertices[tri_0_e1]);
 
     tri_0.vertices[tri_0_e1] = old_tri_1.vertices[o_edge_id];
     tri_0.opposite_triangle[edge_id] = old_tri_1.opposite_triangle[tri_1_e1];
-    tri_0.opposite_triangle[tri_0_e0] = tri_id_1;
+    tri_0.opposite_triangle[tri_0_e0] = { tri_id_1, tri_1_e1 };
 
     tri_1.vertices[tri_1_e0] = old_tri_0.vertices[edge_id];
     tri_1.opposite_triangle[o_edge_id] = old_tri_0.opposite_triangle[tri_0_e0];
-    tri_1.opposite_triangle[tri_1_e1] = tri_id_0;
-
-    mesh.vertex_to_triangle[old_tri_0.vertices[edge_id]] = tri_id_0; 
-    mesh.vertex_to_triangle[old_tri_0.vertices[tri_0_e0]] = tri_id_0;
-    mesh.vertex_to_triangle[old_tri_0.vertices[tri_0_e1]] = tri_id_1;
-    mesh.vertex_to_triangle[old_tri_1.vertices[o_edge_id]] = tri_id_1;
+    tri_1.opposite_triangle[tri_1_e1] = { tri_id_0, tri_0_e0 };
+
+    // The outer edges keep their constraint flags, the new diagonal has none
+    tri_0.set_constrained(edge_id, old_tri_1.is_constrained(tri_1_e1));
+    tri_0.set_constrained(tri_0_e0, false);
+    tri_1.set_constrained(o_edge_id, old_tri_0.is_constrained(tri_0_e0));
+    tri_1.set_constrained(tri_1_e1, false);
+
+    // Concurrent flips can share a vertex, any of their triangles is valid for it
+    #pragma omp atomic write
+    raw_id(mesh.vertex_to_triangle[old_tri_0.vertices[edge_id]]) = tri_id_0; 
+    #pragma omp atomic write
+    raw_id(mesh.vertex_to_triangle[old_tri_0.vertices[tri_0_e0]]) = tri_id_0;
+    #pragma omp atomic write
+    raw_id(mesh.vertex_to_triangle[old_tri_0.vertices[tri_0_e1]]) = tri_id_1;
+    #pragma omp atomic write
+    raw_id(mesh.vertex_to_triangle[old_tri_1.vertices[o_edge_id]]) = tri_id_1;
 
     size_t adj_tri_0 = tri_0.opposite_triangle[edge_id];
     size_t adj_tri_1 = tri_1.opposite_triangle[o_edge_id];
 
-    if (adj_tri_0 != size_t_max){
-      const auto edge = tri_0.get_edge(edge_id);
-      MTriangle& tri = mesh.triangles[adj_tri_0];
-      const LocalId<3> a_edge_id = tri.find_edge(edge);
-      tri.opposite_triangle[a_edge_id] = tri_id_0;
-    }
-
-    if (adj_tri_1 != size_t_max){
-      const auto edge = tri_1.get_edge(o_edge_id);
-      MTriangle& tri = mesh.triangles[adj_tri_1];
-      const LocalId<3> a_edge_id = tri.find_edge(edge);
-      tri.opposite_triangle[a_edge_id] = tri_id_1;
-    }
+    if (adj_tri_0 != size_t_max)
+      mesh.triangles[adj_tri_0].opposite_triangle[mesh.opposite_edge(tri_0, edge_id)] = { tri_id_0, edge_id };
 
-    assert_triangle_mesh_valid(mesh);
+    if (adj_tri_1 != size_t_max)
+      mesh.triangles[adj_tri_1].opposite_triangle[mesh.opposite_edge(tri_1, o_edge_id)] = { tri_id_1, o_edge_id };
   }
 }
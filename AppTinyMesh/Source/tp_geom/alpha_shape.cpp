@@ -0,0 +1,118 @@
+#include <tp_geom/alpha_shape.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// A boundary edge is followed by the next one around its end : the triangles of the shape around the end
+// are crossed one after the other, until the edge leading out of the shape. The loops therefore don't
+// jump between two parts of the shape touching at a vertex
+
+AlphaShape::AlphaShape(const TriangleMesh& mesh): mesh(&mesh) {
+  const size_t n = mesh.triangles.size();
+  std::vector<double> radius(n, 0), tri_area(n, 0);
+
+  #pragma omp parallel for schedule(static)
+  for (long t = 0; t < long(n); t++){
+    const MTriangle& tri = mesh.triangles[t];
+    if (tri.is_free() || tri.is_infinite()) continue;
+
+    // R = abc / 4K, a flat triangle has an infinite radius
+    const auto [a, b, c] = mesh.get_vertices(tri);
+    const double cross = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+    const double lengths = std::sqrt(squared_distance_2d(a, b) * squared_distance_2d(b, c) * squared_distance_2d(c, a));
+    radius[t] = cross > 0 ? lengths / (2 * cross) : std::numeric_limits<double>::infinity();
+    tri_area[t] = cross / 2;
+  }
+
+  for (size_t t = 0; t < n; t++)
+    if (!mesh.triangles[t].is_free() && !mesh.triangles[t].is_infinite()) order.push_back(t);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b){ return radius[a] < radius[b] || (radius[a] == radius[b] && a < b); });
+
+  radii.resize(order.size());
+  area_prefix.assign(order.size() + 1, 0);
+  rank.assign(n, size_t_max);
+
+  for (size_t i = 0; i < order.size(); i++){
+    radii[i] = radius[order[i]];
+    area_prefix[i + 1] = area_prefix[i] + tri_area[order[i]];
+    rank[order[i]] = i;
+  }
+
+  neighbour_ranks.resize(3 * order.size());
+  #pragma omp parallel for schedule(static)
+  for (long i = 0; i < long(order.size()); i++)
+    for (int e = 0; e < 3; e++)
+      neighbour_ranks[3 * i + e] = rank[mesh.triangles[order[i]].opposite_triangle[e]];
+}
+
+size_t AlphaShape::triangle_count(double alpha) const {
+  return std::upper_bound(radii.begin(), radii.end(), alpha) - radii.begin();
+}
+
+std::vector<size_t> AlphaShape::triangles(double alpha) const {
+  return std::vector<size_t>(order.begin(), order.begin() + triangle_count(alpha));
+}
+
+bool AlphaShape::contains(size_t tri_id, double alpha) const {
+  return kept(tri_id, triangle_count(alpha));
+}
+
+double AlphaShape::area(double alpha) const {
+  return area_prefix[triangle_count(alpha)];
+}
+
+std::vector<std::pair<size_t, LocalId<3>>> AlphaShape::boundary_sides(size_t count) const {
+  std::vector<std::pair<size_t, LocalId<3>>> sides;
+  for (size_t i = 0; i < 3 * count; i++)
+    if (neighbour_ranks[i] >= count) sides.push_back({ order[i / 3], int(i % 3) });
+  return sides;
+}
+
+std::vector<std::pair<size_t, size_t>> AlphaShape::boundary_edges(double alpha) const {
+  const std::vector<std::pair<size_t, LocalId<3>>> sides = boundary_sides(triangle_count(alpha));
+  std::vector<std::pair<size_t, size_t>> edges(sides.size());
+
+  for (size_t i = 0; i < sides.size(); i++){
+    const auto [tri_id, id] = sides[i];
+    edges[i] = { mesh->triangles[tri_id].vertices[id + 1], mesh->triangles[tri_id].vertices[id + 2] };
+  }
+
+  return edges;
+}
+
+std::vector<std::vector<size_t>> AlphaShape::boundary_loops(double alpha) const {
+  const size_t count = triangle_count(alpha);
+  std::vector<std::vector<size_t>> loops;
+  std::vector<uint8_t> visited(mesh->triangles.size(), 0); // Bit e of a triangle once its edge e is in a loop
+
+  for (const auto& [start, start_id] : boundary_sides(count)){
+    if (visited[start] >> start_id & 1) continue;
+
+    // The edge (v[id + 1], v[id + 2]) of tri_id, then the next one from its end
+    std::vector<size_t> loop;
+    size_t tri_id = start;
+    LocalId<3> id = start_id;
+    do {
+      visited[tri_id] |= 1 << id;
+      loop.push_back(mesh->triangles[tri_id].vertices[id + 1]);
+
+      const size_t end = mesh->triangles[tri_id].vertices[id + 2];
+      LocalId<3> end_id = id + 2;
+      while (true){
+        // Edge from the end to the next vertex of the triangle
+        const size_t next = mesh->triangles[tri_id].opposite_triangle[end_id + 2];
+        if (!kept(next, count)){
+          id = end_id + 2;
+          break;
+        }
+        tri_id = next;
+        end_id = mesh->triangles[tri_id].local_id_of(end);
+      }
+    } while (tri_id != start || id != start_id);
+
+    loops.push_back(std::move(loop));
+  }
+
+  return loops;
+}
@@ -3,17 +3,104 @@
 #include <stack>
 #include <tp_geom/delaunay.h>
 #include <tp_geom/algo.h>
-#include <unordered_set>
+#include <tp_geom/spatial_sort.h>
 
 Triangulation2D Triangulation2D::from_point_cloud(const std::vector<Vector> points){
   Triangulation2D tri;
-  int i = 0;
-  for (const Vector& p : points){
-    tri.add_point(p);
-    i++;
+  tri.build(points);
+  return tri;
+}
+
+// The triangulation of V vertices (the infinite one included) ends with 2 V - 4 triangles,
+// a mesh too big for its ids fails before the work rather than near the end
+static void check_final_size(const TriangleMesh& mesh, size_t added){
+  const size_t vertex_count = std::max<size_t>(mesh.vertices.size() + added, 2);
+  TriangleMesh::check_size(vertex_count, 2 * vertex_count - 4);
+}
+
+// The first triangle is made of the first three inserted points, they must not be aligned
+static void make_first_triangle_valid(const std::vector<Vector>& points, std::vector<size_t>& order){
+  if (order.size() < 3) return;
+
+  const Vector& a = points[order[0]];
+  size_t second = 1;
+  while (second < order.size() && points[order[second]][0] == a[0] && points[order[second]][1] == a[1])
+    second++;
+
+  if (second == order.size()) return;
+  std::swap(order[1], order[second]);
+
+  const Vector& b = points[order[1]];
+  for (size_t k = 2; k < order.size(); k++){
+    if (orientation_2d({ a, b, points[order[k]] }) != TriOrient::Flat){
+      std::swap(order[2], order[k]);
+      return;
+    }
   }
+}
 
-  return tri;
+std::vector<size_t> Triangulation2D::build(const std::vector<Vector>& points){
+  check_final_size(mesh, points.size());
+  std::vector<size_t> order = SpatialSort::brio_order(points);
+  std::vector<size_t> ids(points.size(), size_t_max);
+
+  if (mesh.vertices.size() == 1)
+    make_first_triangle_valid(points, order);
+
+  mesh.vertices.reserve(mesh.vertices.size() + points.size());
+  mesh.vertex_to_triangle.reserve(mesh.vertex_to_triangle.size() + points.size());
+  mesh.triangles.reserve(mesh.triangles.size() + 2 * points.size());
+
+  for (size_t i : order)
+    ids[i] = add_point(points[i]);
+
+  return ids;
+}
+
+// Hull vertex j gets the id j + 1. The fan triangle k of the hull polygon (vertices 0, k, k + 1) is at k - 1,
+// the infinite triangle of the hull edge i (vertices i, i + 1) is at h - 2 + i
+std::vector<size_t> Triangulation2D::build_from_hull(const std::vector<Vector>& points, const std::vector<size_t>& hull){
+  assert(mesh.vertices.size() == 1 && mesh.triangles.empty());
+  const size_t h = hull.size();
+  if (h < 3) return build(points);
+
+  check_final_size(mesh, points.size());
+  std::vector<size_t> ids(points.size(), size_t_max);
+  mesh.vertices.reserve(points.size() + 1);
+  mesh.vertex_to_triangle.reserve(points.size() + 1);
+  mesh.triangles.reserve(2 * points.size());
+
+  for (size_t i : hull)
+    ids[i] = mesh.add_point(points[i]);
+
+  const auto inf_tri = [&](size_t i){ return h - 2 + i % h; };
+  mesh.triangles.resize(2 * h - 2);
+
+  for (size_t k = 1; k + 1 < h; k++){
+    MTriangle& tri = mesh.triangles[k - 1];
+    tri.vertices = { 1, k + 1, k + 2 };
+    tri.opposite_triangle = { inf_tri(k), k + 2 < h ? k : inf_tri(h - 1), k > 1 ? k - 2 : inf_tri(0) };
+  }
+
+  for (size_t i = 0; i < h; i++){
+    MTriangle& tri = mesh.triangles[inf_tri(i)];
+    tri.vertices = { mesh.infinite_point, (i + 1) % h + 1, i + 1 };
+    tri.opposite_triangle = { std::clamp<size_t>(i, 1, h - 2) - 1, inf_tri(i + h - 1), inf_tri(i + 1) };
+    mesh.vertex_to_triangle[i + 1] = size_t(tri.opposite_triangle[0]);
+  }
+  mesh.vertex_to_triangle[mesh.infinite_point] = inf_tri(0);
+  assert_triangle_mesh_valid(mesh);
+
+  // The fan is made Delaunay before the insertions, as if the hull vertices were inserted first
+  TriMeshAlgorithm::make_delaunay(mesh);
+  for (size_t v = 1; v <= h; v++)
+    sample_grid.insert(mesh, v);
+  locate_hint = 0;
+
+  for (size_t i : SpatialSort::brio_order(points))
+    if (ids[i] == size_t_max) ids[i] = add_point(points[i]);
+
+  return ids;
 }
 
 TriOrient reorient_ccw(const TriangleMesh& mesh, MTriangle& tri){
@@ -40,14 +127,42 @@ Triangulation2D::FoundTri Triangulation2D::find_nearest_triangle(const Vector& p
   if (mesh.triangles.size() == 0) 
     return {size_t_max, size_t_max, TriOrient::Flat};
 
-  size_t tri_id; 
-  const MTriangle* it;
-  
-  do {
-    tri_id = rand() % mesh.triangles.size();
-    it = &mesh.triangles[tri_id];
-  } while(it->local_id_of(mesh.infinite_point) >= 0);
+  bool jumped = false;
+  const size_t start = start_triangle(point, locate_hint, jumped);
+  const FoundTri found = walk(point, start, walk_stats.steps);
+
+  walk_stats.walks++;
+  walk_stats.jumps += jumped;
+  locate_hint = std::get<0>(found);
+  return found;
+}
+
+size_t Triangulation2D::start_triangle(const Vector& point, size_t hint_tri, bool& jumped) const {
+  // Steps from an hull triangle to its finite side
+  const auto finite_side = [&](size_t tri_id){
+    const LocalId<3> inf_id = mesh.triangles[tri_id].local_id_of(mesh.infinite_point);
+    return inf_id.is_valid() ? size_t(mesh.triangles[tri_id].opposite_triangle[inf_id]) : tri_id;
+  };
+
+  // The hint may be stale if the mesh was edited by hand
+  size_t tri_id = finite_side(hint_tri < mesh.triangles.size() ? hint_tri : 0); 
+
+  // Jump to the nearest sampled vertex when it is closer than the hint
+  const double hint_d2 = squared_distance_2d(mesh.get_vertex(mesh.triangles[tri_id], 0), point);
+  const size_t sample = sample_grid.nearest(mesh, point, hint_d2);
+  jumped = sample != size_t_max;
+  if (jumped)
+    tri_id = finite_side(mesh.vertex_to_triangle[sample]);
+
+  return tri_id;
+}
 
+// Visibility walk from a finite triangle, crosses the edges the point is behind of.
+// When the point is behind both edges the choice is random (stochastic walk), a fixed one can
+// loop forever on a triangulation that isn't Delaunay, like a constrained one
+Triangulation2D::FoundTri Triangulation2D::walk(const Vector& point, size_t tri_id, size_t& steps) const {
+  uint32_t coin = 0x9E3779B9u ^ uint32_t(tri_id);
+  const MTriangle* it = &mesh.triangles[tri_id];
   std::array<Vector, 3> tri_v = mesh.get_vertices(*it);
 
   unsigned char min_edge_id = 0;
@@ -67,10 +182,10 @@ Triangulation2D::FoundTri Triangulation2D::find_nearest_triangle(const Vector& p
 
   while (min_ori == TriOrient::CW){
     size_t next_id = it->opposite_triangle[min_edge_id];
-    MTriangle* next = &mesh.triangles[next_id];
+    const MTriangle* next = &mesh.triangles[next_id];
     if (next->is_infinite()) break;
 
-    LocalId<3> next_eid = next->find_edge(it->get_edge(min_edge_id));
+    LocalId<3> next_eid = mesh.opposite_edge(*it, min_edge_id);
     tri_v = mesh.get_vertices(*next);
 
     TriOrient e0 = orientation_2d({ tri_v[next_eid - 1], tri_v[next_eid], point});
@@ -79,18 +194,76 @@ Triangulation2D::FoundTri Triangulation2D::find_nearest_triangle(const Vector& p
     min_ori = e0;
     min_edge_id = next_eid + 1;
     
-    if (e1 < min_ori){
+    coin ^= coin << 13;
+    coin ^= coin >> 17;
+    coin ^= coin << 5;
+
+    if (e1 < min_ori || (e1 == TriOrient::CW && e0 == TriOrient::CW && (coin & 1))){
       min_ori = e1;
       min_edge_id = next_eid - 1;
     }
 
     tri_id = next_id;
     it = next;
+    steps++;
   }
 
   return {tri_id, min_edge_id, min_ori}; 
 }
 
+std::vector<Triangulation2D::LocatedTri> Triangulation2D::locate(const std::vector<Vector>& points) const {
+  // Queries per chunk, each chunk is a continuous piece of the Hilbert curve
+  constexpr size_t chunk_size = 1024;
+
+  std::vector<LocatedTri> located(points.size());
+  if (mesh.triangles.size() == 0) return located;
+
+  const std::vector<size_t> order = SpatialSort::hilbert_order(points);
+  const long chunks = long((order.size() + chunk_size - 1) / chunk_size);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (long c = 0; c < chunks; c++){
+    const size_t begin = c * chunk_size;
+    const size_t end = std::min(order.size(), begin + chunk_size);
+    size_t hint = locate_hint;
+
+    for (size_t i = begin; i < end; i++){
+      const Vector& point = points[order[i]];
+      bool jumped = false;
+      size_t steps = 0;
+
+      const auto [tri_id, edge_id, orient] = walk(point, start_triangle(point, hint, jumped), steps);
+      hint = tri_id;
+
+      LocatedTri& loc = located[order[i]];
+      loc.triangle = tri_id;
+      loc.inside = orient != TriOrient::CW;
+      loc.barycentric = barycentric_2d(mesh.get_vertices(mesh.triangles[tri_id]), point);
+    }
+  }
+
+  return located;
+}
+
+MeshRemap Triangulation2D::reorder(Ordering ordering){
+  MeshRemap remap = mesh.reorder(ordering);
+  remap_locator(remap);
+  return remap;
+}
+
+MeshRemap Triangulation2D::compact(){
+  MeshRemap remap = mesh.compact();
+  remap_locator(remap);
+  return remap;
+}
+
+// The sampled vertices are never free, the hint may be (dropped by compact), the walks then start from 0
+void Triangulation2D::remap_locator(const MeshRemap& remap){
+  locate_hint = locate_hint < remap.triangles.size() ? remap.triangles[locate_hint] : size_t_max;
+  if (locate_hint == size_t_max) locate_hint = 0;
+  sample_grid.remap(remap.vertices);
+}
+
 // Creates the first triangle and hull
 // The hull is oriented CW instead of CCW to allow operations 
 // like add_point_in_face to generate CCW triangles inside the surface
@@ -111,7 +284,7 @@ void Triangulation2D::init_first_triangle(){
     // htri.opposite_triangle = { 0, 1ul + (id + 1), 1ul + (id + 2) };
 
     htri.vertices = { mesh.infinite_point, tri.vertices[id - 1], tri.vertices[id + 1] };
-    htri.opposite_triangle = { 0, 1ul + (id + 1), 1ul + (id - 1)};
+    htri.opposite_triangle = { 0, 1ul + (id - 1), 1ul + (id + 1) };
     mesh.triangles.emplace_back(htri);
   }
 
@@ -124,30 +297,68 @@ void Triangulation2D::init_first_triangle(){
 }
 
 size_t Triangulation2D::add_point(const Vector& point){
-  if (mesh.triangles.size() == 0) {
-    size_t point_id = mesh.add_point(point);
-    if (mesh.vertices.size() >= 4)
-      init_first_triangle();
+  const FoundTri found = find_nearest_triangle(point);
+  const size_t duplicate = vertex_on(std::get<0>(found), point);
+  if (duplicate != size_t_max) return duplicate;
 
-    return point_id;
-  }
+  return insert_located(point, found);
+}
 
-  const auto& [tri_id, edge_id, orient] = find_nearest_triangle(point);
+// The walk ends on a triangle holding the point, the point is then one of its vertices if it is on one.
+// A copy of an hull vertex inserted again would make a flat hull triangle, then the walks loop on it
+size_t Triangulation2D::vertex_on(size_t tri_id, const Vector& point) const {
+  const auto same_xy = [&](size_t v){ return mesh.vertices[v][0] == point[0] && mesh.vertices[v][1] == point[1]; };
+
+  // Before the first triangle, the vertices waiting for it. It is made from the first three, at most two
+  // are checked whatever the number of copies or aligned points at the start
+  if (tri_id == size_t_max){
+    const size_t pending_end = std::min<size_t>(mesh.vertices.size(), mesh.v_start_offset + 2);
+    for (size_t v = mesh.v_start_offset; v < pending_end; v++)
+      if (same_xy(v)) return v;
+    return size_t_max;
+  }
 
-  switch (orient){
-    // Inside the triangle, on a edge
-    case TriOrient::Flat: 
-      return TriMeshAlgorithm::split_edge(mesh, tri_id, edge_id, point);
+  for (size_t v : mesh.triangles[tri_id].vertices)
+    if (v != mesh.infinite_point && same_xy(v)) return v;
+  return size_t_max;
+}
 
-    // Outside of the domain
-    case TriOrient::CW:
-      return add_point_outside_hull(tri_id, edge_id, point);
+size_t Triangulation2D::insert_located(const Vector& point, const FoundTri& found){
+  size_t point_id = size_t_max;
 
-    // Inside the triangle
-    case TriOrient::CCW:
-      const auto [point_id, _] = TriMeshAlgorithm::split_face(mesh, tri_id, point);
-      return point_id;
+  if (mesh.triangles.size() == 0) {
+    point_id = mesh.add_point(point);
+    if (mesh.vertices.size() >= 4)
+      init_first_triangle();
+  }
+  else {
+    const auto& [tri_id, edge_id, orient] = found;
+
+    switch (orient){
+      // Inside the triangle, on a edge
+      case TriOrient::Flat: 
+        point_id = TriMeshAlgorithm::split_edge(mesh, tri_id, edge_id, point);
+        break;
+
+      // Outside of the domain
+      case TriOrient::CW:
+        point_id = add_point_outside_hull(tri_id, edge_id, point);
+        break;
+
+      // Inside the triangle
+      case TriOrient::CCW:
+        point_id = TriMeshAlgorithm::split_face(mesh, tri_id, point).first;
+        break;
+    }
   }
+
+  sample_grid.insert(mesh, point_id);
+  return point_id;
+}
+
+size_t Triangulation2D::add_point(const Vector& point, size_t hint_tri){
+  locate_hint = hint_tri;
+  return add_point(point);
 }
 
 size_t Triangulation2D::add_point_outside_hull(size_t nearest_tri, const LocalId<3> nearest_eid, const Vector& point){
@@ -194,8 +405,9 @@ size_t Triangulation2D::add_point_outside_hull(size_t nearest_tri, const LocalId
       const Vector p1 = mesh.get_vertex(*face_it, inf_id + 1);
       const Vector p2 = mesh.get_vertex(*face_it, inf_id + 2);
 
+      // A hull edge aligned with the point stays, the flip would make a flat triangle
       TriOrient orient = orientation_2d({ p1, p2, point });
-      if (orient < TriOrient::Flat) break;
+      if (orient != TriOrient::CCW) break;
       tris_to_flip.emplace_back(face_it.get_tri_id());
 
       face_it = face_it + sign;
@@ -216,22 +428,28 @@ size_t Triangulation2D::add_point_outside_hull(size_t nearest_tri, const LocalId
 }
 
 using Edge = std::pair<size_t, size_t>;
-struct EdgeHasher {
-  size_t operator()(const Edge &face) const noexcept {
-    const auto &[a, b] = face;
-    return a + b;
+
+size_t DelaunayTriangulation2D::add_point(const Vector& point) {
+  insert_stats.inserts++;
+
+  const FoundTri found = find_nearest_triangle(point);
+  const size_t duplicate = vertex_on(std::get<0>(found), point);
+  if (duplicate != size_t_max){
+    insert_stats.duplicates++;
+    return duplicate;
   }
-};
 
-Edge sort_edge(Edge edge){
-    if (edge.first > edge.second)
-      std::swap(edge.first, edge.second);
+  if (kernel == Kernel::Cavity && mesh.triangles.size() > 0){
+    const size_t point_id = insert_in_cavity(point, found);
+    if (point_id != size_t_max) return point_id;
+    insert_stats.fallbacks++;
+  }
 
-    return edge;
+  return insert_with_flips(point, found);
 }
 
-size_t DelaunayTriangulation2D::add_point(const Vector& point) {
-  size_t point_id = Base::add_point(point);
+size_t DelaunayTriangulation2D::insert_with_flips(const Vector& point, const FoundTri& found) {
+  size_t point_id = insert_located(point, found);
   if (mesh.triangles.size() == 0) return point_id;
   
   auto face_begin = mesh.faces_around_v(point_id);
@@ -264,10 +482,11 @@ size_t DelaunayTriangulation2D::add_point(const Vector& point) {
       MTriangle& o_tri = mesh.triangles[o_tri_id];
       assert(!o_tri.is_infinite());
 
-      const LocalId<3> o_edge_id = o_tri.find_edge(tri.get_edge(edge_id));
+      const LocalId<3> o_edge_id = mesh.opposite_edge(tri, edge_id);
       const Edge new_edge = { tri.vertices[edge_id], o_tri.vertices[o_edge_id]};
 
       TriMeshAlgorithm::edge_flip(mesh, tri_id, edge_id);
+      insert_stats.flips++;
       
       assert(tri.local_id_of(point_id).is_valid());
       assert(o_tri.local_id_of(point_id).is_valid());
@@ -281,26 +500,184 @@ size_t DelaunayTriangulation2D::add_point(const Vector& point) {
   return point_id;
 }
 
+size_t DelaunayTriangulation2D::insert_in_cavity(const Vector& point, const FoundTri& found) {
+  const auto [found_id, edge_id, orient] = found;
+  // Outside of the domain, the cavity starts from the hull triangle facing the point
+  const size_t seed = orient == TriOrient::CW ? size_t(mesh.triangles[found_id].opposite_triangle[edge_id]) : found_id;
+
+  // An hull triangle conflicts when the point is strictly outside of its edge, 
+  // or on the edge line and in the circumcircle of the finite triangle behind
+  const auto in_conflict = [&](size_t tri_id){
+    const MTriangle& tri = mesh.triangles[tri_id];
+    const LocalId<3> inf_id = tri.local_id_of(mesh.infinite_point);
+    if (!inf_id.is_valid())
+      return in_circle_2d(mesh.get_vertices(tri), point) > 0;
+
+    const TriOrient hull_orient = orientation_2d({ mesh.get_vertex(tri, inf_id + 1), mesh.get_vertex(tri, inf_id + 2), point });
+    if (hull_orient != TriOrient::Flat)
+      return hull_orient == TriOrient::CCW;
+
+    const MTriangle& finite = mesh.triangles[tri.opposite_triangle[inf_id]];
+    return in_circle_2d(mesh.get_vertices(finite), point) > 0;
+  };
+
+  enum : char { Unknown = 0, Inside = 1, Outside = 2 };
+  cavity_state.resize(mesh.triangles.size(), Unknown);
+  cavity.clear();
+  cavity_boundary.clear();
+  cavity_rejected.clear();
+
+  const auto reset_state = [&](){
+    for (size_t t : cavity) cavity_state[t] = Unknown;
+    for (size_t t : cavity_rejected) cavity_state[t] = Unknown;
+  };
+
+  // Breadth first search of the triangles in conflict, the constrained edges aren't crossed
+  cavity.push_back(seed);
+  cavity_state[seed] = Inside;
+
+  for (size_t i = 0; i < cavity.size(); i++){
+    const size_t tri_id = cavity[i];
+
+    for (int e = 0; e < 3; e++){
+      const size_t o_tri_id = mesh.triangles[tri_id].opposite_triangle[e];
+      if (mesh.triangles[tri_id].is_constrained(e)){
+        cavity_boundary.push_back({ tri_id, e });
+        continue;
+      }
+
+      char& state = cavity_state[o_tri_id];
+
+      if (state == Unknown){
+        state = in_conflict(o_tri_id) ? Inside : Outside;
+        (state == Inside ? cavity : cavity_rejected).push_back(o_tri_id);
+      }
+
+      if (state == Outside)
+        cavity_boundary.push_back({ tri_id, e });
+    }
+  }
+
+  // Rounding errors can give a cavity that isn't a disk seen by the point, 
+  // it would make a broken star. A disk of c triangles has c + 2 boundary edges.
+  // A cavity on both sides of a constraint fails too, the point can't see both sides
+  bool is_star = cavity_boundary.size() == cavity.size() + 2;
+
+  for (size_t i = 0; is_star && i < cavity_boundary.size(); i++){
+    const auto [tri_id, e] = cavity_boundary[i];
+    const auto [a, b] = mesh.triangles[tri_id].get_edge(e);
+    if (a == mesh.infinite_point || b == mesh.infinite_point) continue;
+    is_star = orientation_2d({ mesh.vertices[a], mesh.vertices[b], point }) == TriOrient::CCW;
+  }
+
+  if (!is_star){
+    reset_state();
+    return size_t_max;
+  }
+
+  // New triangle i is (point, a, b) where (a, b) is the boundary edge i, 
+  // it takes the slot of a cavity triangle, the two last ones get theirs once the cavity is accepted
+  star.resize(cavity_boundary.size());
+  star_by_a.resize(cavity_boundary.size());
+
+  for (size_t i = 0; i < star.size(); i++){
+    const auto [tri_id, e] = cavity_boundary[i];
+    const MTriangle& tri = mesh.triangles[tri_id];
+    const auto [a, b] = tri.get_edge(e);
+
+    star[i] = { a, b, tri.opposite_triangle[e], mesh.opposite_edge(tri, e), i < cavity.size() ? cavity[i] : size_t_max, tri.is_constrained(e) };
+    star_by_a[i] = { a, i };
+  }
+
+  std::sort(star_by_a.begin(), star_by_a.end());
+  for (size_t i = 1; i < star_by_a.size(); i++){
+    // The boundary goes twice through a vertex
+    if (star_by_a[i - 1].first == star_by_a[i].first){
+      reset_state();
+      return size_t_max;
+    }
+  }
+
+  reset_state();
+  insert_stats.cavity_tris += cavity.size();
+
+  const size_t point_id = mesh.add_point(point);
+  for (size_t i = cavity.size(); i < star.size(); i++)
+    star[i].slot = mesh.add_triangle();
+
+  for (size_t i = 0; i < star.size(); i++){
+    const StarTri& st = star[i];
+    const auto next = std::lower_bound(star_by_a.begin(), star_by_a.end(), std::pair<size_t, size_t>{ st.b, 0 });
+    assert(next != star_by_a.end() && next->first == st.b);
+    const StarTri& next_st = star[next->second];
+
+    MTriangle& tri = mesh.triangles[st.slot];
+    tri.vertices = { point_id, st.a, st.b };
+    tri.constraints = st.constrained;
+    mesh.link(st.slot, 0, st.outer, st.outer_edge);
+    mesh.link(st.slot, 1, next_st.slot, 2);
+    mesh.vertex_to_triangle[st.a] = st.slot;
+  }
+
+  mesh.vertex_to_triangle[point_id] = star[0].slot;
+  locate_hint = star[0].slot;
+  sample_grid.insert(mesh, point_id);
+
+  assert_triangle_mesh_valid(mesh);
+  return point_id;
+}
+
 namespace TriMeshAlgorithm{
   bool is_delaunay_2d(const TriangleMesh& mesh) {
-    std::unordered_set<Edge, EdgeHasher> checked;
+    // Triangles per chunk, the in-circle tests of a chunk are gathered and done in one batch
+    constexpr size_t chunk_size = 1024;
+    const long chunks = long((mesh.triangles.size() + chunk_size - 1) / chunk_size);
+    bool delaunay = true;
+
+    #pragma omp parallel for schedule(dynamic) reduction(&&: delaunay)
+    for (long c = 0; c < chunks; c++){
+      const size_t begin = c * chunk_size;
+      const size_t end = std::min(mesh.triangles.size(), begin + chunk_size);
 
-    for (size_t t = 0; t < mesh.triangles.size(); t++){
-      const MTriangle& tri = mesh.triangles[t]; 
-      if (tri.is_infinite()) continue; 
+      // x and y of the corners a, b, c of the triangle and of the opposite vertex d
+      std::vector<double> coords[8];
+      for (auto& v : coords) v.reserve(3 * (end - begin));
 
-      for (int i = 0; i < 3; i++){
-        const Edge edge = sort_edge(tri.get_edge(i));
-        if (checked.count(edge))
-          continue;
+      for (size_t t = begin; t < end; t++){
+        const MTriangle& tri = mesh.triangles[t];
+        if (tri.is_free() || tri.is_infinite()) continue;
 
-        checked.insert(edge);
-        if (!fully_delaunay(mesh, t, i))
-          return false;
+        for (int i = 0; i < 3; i++){
+          // Each edge is tested once, from its triangle with the lowest id
+          const size_t o_tri_id = tri.opposite_triangle[i];
+          assert(o_tri_id != size_t_max);
+          if (o_tri_id < t || tri.is_constrained(i)) continue;
+
+          const MTriangle& o_tri = mesh.triangles[o_tri_id];
+          if (o_tri.is_infinite()) continue;
+
+          const Vector d = mesh.get_vertex(o_tri, mesh.opposite_edge(tri, i));
+          for (int k = 0; k < 3; k++){
+            coords[2 * k].push_back(mesh.vertices[tri.vertices[k]][0]);
+            coords[2 * k + 1].push_back(mesh.vertices[tri.vertices[k]][1]);
+          }
+          coords[6].push_back(d[0]);
+          coords[7].push_back(d[1]);
+        }
       }
+
+      const size_t n = coords[6].size();
+      std::vector<signed char> sign(n);
+      Predicates::in_circle_batch(n,
+        { coords[0].data(), coords[1].data() }, { coords[2].data(), coords[3].data() },
+        { coords[4].data(), coords[5].data() }, { coords[6].data(), coords[7].data() }, sign.data());
+
+      // The in-circle test is symmetric, d inside the circle of tri iff tri's vertex is inside the circle of o_tri
+      for (size_t i = 0; i < n; i++)
+        delaunay = delaunay && sign[i] <= 0;
     }
 
-    return true;
+    return delaunay;
   }
 
   bool is_edge_delaunay_2d(const TriangleMesh &mesh, const size_t tri_id, const LocalId<3> edge_id){
@@ -309,21 +686,14 @@ namespace TriMeshAlgorithm{
     const MTriangle& o_tri = mesh.triangles[o_tri_id];
     assert(o_tri_id != size_t_max);
 
-    if (o_tri.is_infinite())
+    // Constrained edges are kept whatever their circles (constrained Delaunay)
+    if (o_tri.is_infinite() || tri.is_constrained(edge_id))
       return true;
 
-    Vector p = mesh.get_vertex(tri, 0);
-    Vector q = mesh.get_vertex(tri, 1);
-    Vector r = mesh.get_vertex(tri, 2);
-    Vector s = mesh.get_vertex(o_tri, o_tri.find_edge(tri.get_edge(edge_id)));
-
-    Vector u = Vector{q[0] - p[0], q[1] - p[1], std::pow(q[0] - p[0], 2) + std::pow(q[1] - p[1], 2)};
-    Vector v = Vector{r[0] - p[0], r[1] - p[1], std::pow(r[0] - p[0], 2) + std::pow(r[1] - p[1], 2)};
-    Vector w = Vector{s[0] - p[0], s[1] - p[1], std::pow(s[0] - p[0], 2) + std::pow(s[1] - p[1], 2)};
+    const Vector s = mesh.get_vertex(o_tri, mesh.opposite_edge(tri, edge_id));
 
-    // in circle = -signe(((Φ(q)-Φ(p))x(Φ(r)-Φ(p))).(Φ(s)-Φ(p))
-    // WARN: (u/v)*w somehow return the opposite sign compared to desmos simulation
-    return (u/v)*w >= 0; 
+    // Delaunay unless s is strictly inside the circumcircle, cocircular points never flip back and forth
+    return in_circle_2d(mesh.get_vertices(tri), s) <= 0;
   }
   
   bool fully_delaunay(const TriangleMesh &mesh, const size_t tri_id, const LocalId<3> edge_id){
@@ -331,110 +701,76 @@ namespace TriMeshAlgorithm{
     const size_t o_tri_id = tri.opposite_triangle[edge_id];
     const MTriangle& o_tri = mesh.triangles[o_tri_id];
     assert(o_tri_id != size_t_max);
-    const auto o_edge_id = o_tri.find_edge(tri.get_edge(edge_id));
+    const auto o_edge_id = mesh.opposite_edge(tri, edge_id);
     if (o_tri.is_infinite() or tri.is_infinite())
       return true;
 
     return is_edge_delaunay_2d(mesh, tri_id, edge_id) && is_edge_delaunay_2d(mesh, o_tri_id, o_edge_id);
   }
 
-  // TriangleMesh to_delaunay(const Triangulation2D &tri){
-  //   TriangleMesh mesh = tri.get_mesh();
-  //   std::unordered_set<Edge, EdgeHasher> checked;
-  //   std::queue<std::pair<size_t, Edge>> to_check;
-  //
-  //   const auto check_and_push = [&](size_t tri_id, LocalId<3> edge_id){
-  //     const auto edge = sort_edge(mesh.triangles[tri_id].get_edge(edge_id));
-  //     if (checked.count(edge)) return;
-  //     to_check.push({tri_id, edge});
-  //   };
-  //
-  //   const auto flip_and_push_neighbors = [&](size_t tri_id, LocalId<3> edge_id){
-  //     const MTriangle& tri = mesh.triangles[tri_id];
-  //     const size_t o_tri_id = tri.opposite_triangle[edge_id];
-  //     edge_flip(mesh, tri_id, edge_id);
-  //     const MTriangle& o_tri = mesh.triangles[o_tri_id];
-  //     
-  //     assert(!tri.is_infinite() && !o_tri.is_infinite());
-  //     // On pourrait eviter de faire l'operation sur l'edge (ici doublé) flippé mais flemme 
-  //     check_and_push(tri_id, 0);
-  //     check_and_push(tri_id, 1);
-  //     check_and_push(tri_id, 2);
-  //     check_and_push(o_tri_id, 0);
-  //     check_and_push(o_tri_id, 1);
-  //     check_and_push(o_tri_id, 2);
-  //   };
-  //
-  //   for (size_t t = 0; t < mesh.triangles.size(); t++){
-  //     const MTriangle& tri = mesh.triangles[t]; 
-  //     if (tri.is_infinite()) continue; 
-  //
-  //     for (int i = 0; i < 3; i++){
-  //       const Edge edge = sort_edge(tri.get_edge(i));
-  //
-  //       if (checked.count(edge) == 0 && !fully_delaunay(mesh, t, i)) {
-  //         to_check.push({ t, edge });
-  //         // flip_and_push_neighbors(t, i);
-  //       }
-  //     }
-  //   }
-  //
-  //   while (!to_check.empty()) {
-  //     auto [tri_id, edge] = to_check.front();
-  //     MTriangle* tri = &mesh.triangles[tri_id];
-  //     if (!tri->find_edge(edge).is_valid()){
-  //       const auto tri_begin = mesh.faces_around_v(edge.first);
-  //       auto tri_it = tri_begin;
-  //       do {
-  //         if (tri_it->find_edge(edge).is_valid()){
-  //           tri = tri_it;
-  //           tri_id = tri_it.get_tri_id();
-  //           break;
-  //         }
-  //         tri_it++;
-  //       } while (tri_it != tri_begin);
-  //
-  //       assert(tri->find_edge(edge).is_valid());
-  //     }
-  //
-  //     const size_t edge_id = tri->find_edge(edge);
-  //     if (checked.count(edge) == 0 && !fully_delaunay(mesh, tri_id, edge_id)) {
-  //       checked.insert(edge);
-  //       flip_and_push_neighbors(tri_id, edge_id);
-  //     }
-  //     to_check.pop();
-  //   }
-  //
-  //   // assert(is_delaunay_2d(mesh));
-  //   return mesh;
-  // }
-
-  // INFO: Version très naive ... la version au dessus plus intellegente ne fonctionne pas 
-  TriangleMesh to_delaunay(const Triangulation2D& tri) {
-    TriangleMesh mesh = tri.get_mesh();
-    std::unordered_set<Edge, EdgeHasher> checked;
+  FlipStats make_delaunay(TriangleMesh& mesh){
+    using EdgeRef = std::pair<size_t, LocalId<3>>;
+    FlipStats stats;
+
+    // Bit i of queued[t] is set while edge i of triangle t waits in a worklist.
+    // The edges queued during a pass are tested in the next one
+    std::vector<uint8_t> queued(mesh.triangles.size(), 0);
+    std::vector<EdgeRef> current, next;
+
+    const auto push = [&](size_t tri_id, LocalId<3> edge_id){
+      const MTriangle& tri = mesh.triangles[tri_id];
+      if (tri.is_free()) return;
+
+      const size_t o_tri_id = tri.opposite_triangle[edge_id];
+      if (tri.is_infinite() || mesh.triangles[o_tri_id].is_infinite()) return;
+
+      // Already waiting, from this side or the other one
+      const LocalId<3> o_edge_id = mesh.opposite_edge(tri, edge_id);
+      if ((queued[tri_id] >> edge_id & 1) || (queued[o_tri_id] >> o_edge_id & 1)) return;
+
+      queued[tri_id] |= 1 << edge_id;
+      next.push_back({ tri_id, edge_id });
+    };
+
+    for (size_t t = 0; t < mesh.triangles.size(); t++)
+      for (int i = 0; i < 3; i++)
+        push(t, i);
 
-    size_t flips = size_t_max;
-    while (flips > 0){
-      flips = 0;
-      for (size_t t = 0; t < mesh.triangles.size(); t++){
-        const MTriangle& tri = mesh.triangles[t]; 
-        if (tri.is_infinite()) continue; 
+    while (!next.empty()){
+      std::swap(current, next);
+      next.clear();
+      stats.passes++;
 
+      for (const auto& [tri_id, edge_id] : current){
+        // The triangle was rewritten by a flip since the edge was queued
+        if (!(queued[tri_id] >> edge_id & 1)) continue;
+        queued[tri_id] &= ~(1 << edge_id);
+
+        stats.tests++;
+        if (is_edge_delaunay_2d(mesh, tri_id, edge_id)) continue;
+
+        // The quad around a non Delaunay edge is convex, the flip is always valid
+        const size_t o_tri_id = mesh.triangles[tri_id].opposite_triangle[edge_id];
+        edge_flip(mesh, tri_id, edge_id);
+        stats.flips++;
+
+        // Only the 4 outer edges of the quad can have become non Delaunay
+        queued[tri_id] = queued[o_tri_id] = 0;
         for (int i = 0; i < 3; i++){
-          const Edge edge = sort_edge(tri.get_edge(i));
-          if (checked.count(edge))
-            continue;
-
-          if (!fully_delaunay(mesh, t, i)){
-            checked.insert(edge);
-            flips++;
-            edge_flip(mesh, t, i);
-          }
+          if (mesh.triangles[tri_id].opposite_triangle[i] != o_tri_id) push(tri_id, i);
+          if (mesh.triangles[o_tri_id].opposite_triangle[i] != tri_id) push(o_tri_id, i);
         }
       }
     }
 
+    return stats;
+  }
+
+  TriangleMesh to_delaunay(const Triangulation2D& tri, FlipStats* stats) {
+    TriangleMesh mesh = tri.get_mesh();
+    const FlipStats flip_stats = make_delaunay(mesh);
+
+    if (stats) *stats = flip_stats;
     return mesh;
   }
 }
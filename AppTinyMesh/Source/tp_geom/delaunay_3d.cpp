@@ -0,0 +1,319 @@
+#include <tp_geom/delaunay_3d.h>
+#include <tp_geom/predicates.h>
+#include <tp_geom/spatial_sort.h>
+
+// An infinite tet is in conflict with a point strictly beyond its hull face, or on the plane of the face
+// and in the circumsphere of the finite tet behind it (the point is then in the circumcircle of the face).
+// A new tet is the cavity tet of its boundary face with the opposite vertex replaced by the new one, it keeps
+// the orientation. The new tets around the vertex are linked through the edges of the faces, in a small
+// hash table
+
+using Predicates::orient_3d;
+using Predicates::in_sphere;
+
+namespace {
+  bool aligned(const Vector& a, const Vector& b, const Vector& c){
+    const auto yz = [](const Vector& p){ return Vector(p[1], p[2], 0); };
+    const auto zx = [](const Vector& p){ return Vector(p[2], p[0], 0); };
+    return Predicates::orient_2d(a, b, c) == 0 && Predicates::orient_2d(yz(a), yz(b), yz(c)) == 0
+        && Predicates::orient_2d(zx(a), zx(b), zx(c)) == 0;
+  }
+
+  // The two vertices of a tet left out of its faces f and j, in increasing order
+  constexpr int edge_ends[4][4][2] = {
+    { { 0, 0 }, { 2, 3 }, { 1, 3 }, { 1, 2 } },
+    { { 2, 3 }, { 0, 0 }, { 0, 3 }, { 0, 2 } },
+    { { 1, 3 }, { 0, 3 }, { 0, 0 }, { 0, 1 } },
+    { { 1, 2 }, { 0, 2 }, { 0, 1 }, { 0, 0 } },
+  };
+
+  double orient_with(const std::array<Vector, 4>& p, int i, const Vector& point){
+    std::array<Vector, 4> q = p;
+    q[i] = point;
+    return orient_3d(q[0], q[1], q[2], q[3]);
+  }
+}
+
+size_t DelaunayTriangulation3D::add_point(const Vector& point){
+  insert_stats.inserts++;
+
+  if (mesh.tets.empty()){
+    const auto [it, added] = pending_ids.insert({ { point[0], point[1], point[2] }, size_t_max });
+    if (!added){
+      insert_stats.duplicates++;
+      return it->second;
+    }
+
+    const size_t vertex = mesh.add_point(point);
+    it->second = vertex;
+    pending.push_back(vertex);
+    if (init_first_tet(vertex)){
+      for (size_t v : pending)
+        if (mesh.vertex_to_tet[v] == size_t_max)
+          insert(v, walk(mesh.vertices[v], locate_hint));
+
+      pending.clear();
+      pending_ids.clear();
+    }
+
+    return vertex;
+  }
+
+  const size_t seed = walk(point, locate_hint);
+  const size_t duplicate = vertex_on(seed, point);
+  if (duplicate != size_t_max){
+    insert_stats.duplicates++;
+    return duplicate;
+  }
+
+  const size_t vertex = mesh.add_point(point);
+  insert(vertex, seed);
+  return vertex;
+}
+
+std::vector<size_t> DelaunayTriangulation3D::build(const std::vector<Vector>& points){
+  const std::vector<size_t> order = SpatialSort::brio_order_3d(points);
+  std::vector<size_t> ids(points.size(), size_t_max);
+
+  mesh.vertices.reserve(mesh.vertices.size() + points.size());
+  mesh.vertex_to_tet.reserve(mesh.vertex_to_tet.size() + points.size());
+  mesh.tets.reserve(mesh.tets.size() + 7 * points.size());
+
+  for (size_t i : order)
+    ids[i] = add_point(points[i]);
+
+  return ids;
+}
+
+bool DelaunayTriangulation3D::init_first_tet(size_t vertex){
+  const Vector& p = mesh.vertices[vertex];
+
+  // Only the new point is tested, a long aligned or coplanar start stays linear
+  if (first[0] == size_t_max){
+    first[0] = vertex;
+    return false;
+  }
+  if (first[1] == size_t_max){
+    first[1] = vertex; // Distinct from the first one
+    return false;
+  }
+
+  const Vector& a = mesh.vertices[first[0]];
+  const Vector& b = mesh.vertices[first[1]];
+  if (first[2] == size_t_max){
+    if (!aligned(a, b, p)) first[2] = vertex;
+    return false;
+  }
+
+  const double orient = orient_3d(a, b, mesh.vertices[first[2]], p);
+  if (orient == 0) return false;
+
+  MTet tet({ first[0], first[1], first[2], vertex });
+  if (orient < 0) std::swap(tet.vertices[0], tet.vertices[1]);
+
+  const size_t finite = mesh.add_tet();
+  std::array<size_t, 4> infinite;
+  for (int i = 0; i < 4; i++){
+    infinite[i] = mesh.add_tet();
+    tet.opposite_tet[i] = infinite[i];
+  }
+  mesh.tets[finite] = tet;
+
+  // Tet i replaces the vertex i by the infinite one, and swaps two others to turn back the face
+  for (int i = 0; i < 4; i++){
+    MTet inf_tet;
+    inf_tet.vertices = tet.vertices;
+    inf_tet.vertices[i] = TetMesh::infinite_point;
+    std::swap(inf_tet.vertices[(i + 1) % 4], inf_tet.vertices[(i + 2) % 4]);
+    mesh.tets[infinite[i]] = inf_tet;
+  }
+
+  for (int i = 0; i < 4; i++){
+    MTet& inf_tet = mesh.tets[infinite[i]];
+    inf_tet.opposite_tet[i] = finite;
+    // Across the face without the vertex j, the infinite tet of the face j
+    for (int j = 0; j < 4; j++)
+      if (j != i) inf_tet.opposite_tet[inf_tet.local_id_of(tet.vertices[j])] = infinite[j];
+  }
+
+  for (int i = 0; i < 4; i++)
+    mesh.vertex_to_tet[tet.vertices[i]] = finite;
+  mesh.vertex_to_tet[TetMesh::infinite_point] = infinite[0];
+
+  tet_state.assign(mesh.tets.size(), Unknown);
+  locate_hint = finite;
+  assert_tet_mesh_valid(mesh);
+  return true;
+}
+
+size_t DelaunayTriangulation3D::walk(const Vector& point, size_t tet_id){
+  if (mesh.tets[tet_id].is_infinite())
+    tet_id = mesh.tets[tet_id].opposite_tet[mesh.tets[tet_id].local_id_of(TetMesh::infinite_point)];
+
+  size_t previous = size_t_max;
+  while (true){
+    const MTet& tet = mesh.tets[tet_id];
+    if (tet.is_infinite()) return tet_id;
+
+    // The faces are tried from a random one, the walk can't cycle (stochastic walk)
+    const std::array<Vector, 4> p = mesh.get_vertices(tet);
+    coin = coin * 1664525u + 1013904223u;
+    const int start = coin >> 30;
+
+    size_t next = size_t_max;
+    for (int k = 0; k < 4; k++){
+      const int i = (start + k) & 3;
+      if (tet.opposite_tet[i] != previous && orient_with(p, i, point) < 0){
+        next = tet.opposite_tet[i];
+        break;
+      }
+    }
+
+    if (next == size_t_max) return tet_id;
+    previous = tet_id;
+    tet_id = next;
+    insert_stats.walk_steps++;
+  }
+}
+
+bool DelaunayTriangulation3D::in_conflict(size_t tet_id, const Vector& point) const {
+  const MTet& tet = mesh.tets[tet_id];
+  const LocalId<4> inf = tet.local_id_of(TetMesh::infinite_point);
+
+  if (!inf.is_valid()){
+    const auto p = mesh.get_vertices(tet);
+    return in_sphere(p[0], p[1], p[2], p[3], point) > 0;
+  }
+
+  const double orient = orient_with(mesh.get_vertices(tet), inf, point);
+  if (orient != 0) return orient > 0;
+
+  const auto p = mesh.get_vertices(mesh.tets[tet.opposite_tet[inf]]);
+  return in_sphere(p[0], p[1], p[2], p[3], point) > 0;
+}
+
+size_t DelaunayTriangulation3D::vertex_on(size_t tet_id, const Vector& point) const {
+  for (size_t v : mesh.tets[tet_id].vertices)
+    if (v != TetMesh::infinite_point && mesh.vertices[v][0] == point[0] && mesh.vertices[v][1] == point[1] && mesh.vertices[v][2] == point[2])
+      return v;
+  return size_t_max;
+}
+
+void DelaunayTriangulation3D::insert(size_t vertex, size_t seed){
+  const Vector& point = mesh.vertices[vertex];
+  assert(in_conflict(seed, point));
+
+  cavity.assign(1, seed);
+  cavity_rejected.clear();
+  boundary.clear();
+  tet_state[seed] = InCavity;
+
+  for (size_t i = 0; i < cavity.size(); i++){
+    const size_t c = cavity[i];
+    const MTet tet = mesh.tets[c];
+
+    for (int f = 0; f < 4; f++){
+      const size_t o = tet.opposite_tet[f];
+
+      if (tet_state[o] == InCavity) continue;
+      if (tet_state[o] == Unknown){
+        if (in_conflict(o, point)){
+          tet_state[o] = InCavity;
+          cavity.push_back(o);
+          continue;
+        }
+        tet_state[o] = Rejected;
+        cavity_rejected.push_back(o);
+      }
+
+      // The faces of the outer tets are found before any of them is rewritten
+      boundary.push_back({ tet.vertices, o, uint8_t(f), uint8_t(mesh.tets[o].face_towards(c)) });
+    }
+  }
+
+  for (size_t t : cavity_rejected)
+    tet_state[t] = Unknown;
+  insert_stats.cavity_tets += cavity.size();
+
+  // 3 faces of each new tet are around the vertex, a table twice as large as needed
+  size_t table_size = 16;
+  while (table_size < 6 * boundary.size()) table_size *= 2;
+  if (edge_table.size() < table_size)
+    edge_table.assign(table_size, { size_t_max, size_t_max, size_t_max, 0 });
+  const size_t mask = table_size - 1;
+
+  size_t new_tet = size_t_max;
+  for (size_t k = 0; k < boundary.size(); k++){
+    const BoundaryFace& face = boundary[k];
+    new_tet = k < cavity.size() ? cavity[k] : mesh.add_tet();
+
+    // Its 3 faces around the vertex are all linked below, by this tet or by their other one
+    MTet& tet = mesh.tets[new_tet];
+    tet.vertices = face.vertices;
+    tet.vertices[face.face] = vertex;
+    tet.opposite_tet[face.face] = face.outer;
+    mesh.tets[face.outer].opposite_tet[face.outer_face] = new_tet;
+
+    for (int j = 0; j < 4; j++){
+      if (j == face.face) continue;
+      mesh.vertex_to_tet[tet.vertices[j]] = new_tet;
+
+      // Edge of the face j opposite to the new vertex
+      size_t a = tet.vertices[edge_ends[face.face][j][0]];
+      size_t b = tet.vertices[edge_ends[face.face][j][1]];
+      if (a > b) std::swap(a, b);
+
+      size_t slot = (a * 0x9E3779B97F4A7C15ull ^ b * 0xC2B2AE3D27D4EB4Full) >> 17 & mask;
+      while (edge_table[slot].a != size_t_max && (edge_table[slot].a != a || edge_table[slot].b != b))
+        slot = (slot + 1) & mask;
+
+      EdgeSlot& entry = edge_table[slot];
+      if (entry.a == size_t_max){
+        entry = { a, b, new_tet, j };
+        edge_used.push_back(slot);
+      } else {
+        tet.opposite_tet[j] = entry.tet;
+        mesh.tets[entry.tet].opposite_tet[entry.face] = new_tet;
+      }
+    }
+  }
+  mesh.vertex_to_tet[vertex] = new_tet;
+
+  for (size_t slot : edge_used)
+    edge_table[slot].a = size_t_max;
+  edge_used.clear();
+
+  // Cavities with more tets than faces leave slots
+  for (size_t k = boundary.size(); k < cavity.size(); k++)
+    mesh.remove_tet(cavity[k]);
+  for (size_t t : cavity)
+    tet_state[t] = Unknown;
+  // Grown with the tets, by the same steps
+  if (tet_state.size() < mesh.tets.size())
+    tet_state.resize(mesh.tets.capacity(), Unknown);
+
+  locate_hint = new_tet;
+}
+
+namespace TetMeshAlgorithm {
+  bool is_delaunay_3d(const TetMesh& mesh){
+    bool delaunay = true;
+
+    #pragma omp parallel for schedule(static) reduction(&&: delaunay)
+    for (long t = 0; t < long(mesh.tets.size()); t++){
+      const MTet& tet = mesh.tets[t];
+      if (tet.is_free() || tet.is_infinite()) continue;
+      const auto p = mesh.get_vertices(tet);
+
+      for (int f = 0; f < 4; f++){
+        const MTet& other = mesh.tets[tet.opposite_tet[f]];
+        if (other.is_infinite()) continue;
+
+        const size_t v = other.vertices[other.face_towards(t)];
+        delaunay = delaunay && in_sphere(p[0], p[1], p[2], p[3], mesh.vertices[v]) <= 0;
+      }
+    }
+
+    return delaunay;
+  }
+}
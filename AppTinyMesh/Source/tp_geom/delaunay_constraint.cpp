@@ -0,0 +1,286 @@
+#include <tp_geom/delaunay.h>
+#include <tp_geom/spatial_sort.h>
+#include <algorithm>
+
+// Constrained edges (Anglada) : the segment is walked from a to b, the triangles it crosses make a
+// corridor whose vertices are on the left or on the right of the segment. The corridor is removed and
+// each side is triangulated again as a pseudo-polygon closed by the segment : the triangle on an edge
+// (u, w) takes the vertex c of the chain whose circumcircle (u, w, c) holds no other vertex of the chain,
+// then both sides of c are triangulated the same way. Only the corridor is touched, the cost of an
+// insertion depends on the number of triangles crossed, not on the size of the mesh.
+// The star of a vertex isn't convex, the segment can leave it and cross it again further. The side chain
+// then comes back to this vertex and encloses a pocket of triangles that aren't crossed. The pocket is
+// removed with the corridor, its vertices are inserted again in the new triangles
+
+size_t DelaunayTriangulation2D::insert_constraints(const std::vector<std::pair<size_t, size_t>>& segments){
+  std::vector<Vector> middles(segments.size());
+  for (size_t i = 0; i < segments.size(); i++)
+    middles[i] = (mesh.vertices[segments[i].first] + mesh.vertices[segments[i].second]) / 2;
+
+  // Each walk starts around a vertex, the order only keeps the corridors close in memory
+  size_t inserted = 0;
+  for (size_t i : SpatialSort::hilbert_order(middles))
+    inserted += insert_constraint(segments[i].first, segments[i].second);
+
+  return inserted;
+}
+
+bool DelaunayTriangulation2D::insert_constraint(size_t a, size_t b){
+  assert(a != b && a != mesh.infinite_point && b != mesh.infinite_point);
+  assert(a < mesh.vertices.size() && b < mesh.vertices.size());
+  assert(!mesh.is_free_vertex(a) && !mesh.is_free_vertex(b));
+
+  while (a != b){
+    a = insert_constraint_piece(a, b);
+    if (a == size_t_max) return false;
+  }
+
+  insert_stats.constraints++;
+  return true;
+}
+
+size_t DelaunayTriangulation2D::insert_constraint_piece(size_t a, size_t b){
+  const Vector& pa = mesh.vertices[a];
+  const Vector& pb = mesh.vertices[b];
+  const auto side = [&](size_t v){ return orientation_2d({ pa, pb, mesh.vertices[v] }); };
+
+  // Turns around a : the segment follows an edge (a, v), or leaves a through the triangle (a, v, w)
+  // whose vertex v is on its right and w on its left
+  size_t start = size_t_max;
+  const size_t first = mesh.vertex_to_triangle[a];
+  size_t tri_id = first;
+  do {
+    MTriangle& tri = mesh.triangles[tri_id];
+    const LocalId<3> id = tri.local_id_of(a);
+    const size_t v = tri.vertices[id + 1], w = tri.vertices[id + 2];
+    const TriOrient v_side = v == mesh.infinite_point ? TriOrient::Flat : side(v);
+
+    const Vector av = mesh.vertices[v] - pa, ab = pb - pa;
+    const bool ahead = v_side == TriOrient::Flat && av[0] * ab[0] + av[1] * ab[1] > 0;
+
+    if (v != mesh.infinite_point && (v == b || ahead)){
+      MTriangle& o_tri = mesh.triangles[tri.opposite_triangle[id + 2]];
+      tri.set_constrained(id + 2, true);
+      o_tri.set_constrained(o_tri.find_edge(a, v), true);
+      return v;
+    }
+
+    if (!tri.is_infinite() && v_side == TriOrient::CW && side(w) == TriOrient::CCW){
+      start = tri_id;
+      break;
+    }
+
+    tri_id = tri.opposite_triangle[id + 1];
+  } while (tri_id != first);
+
+  // No way out of a, the input is broken (b on a, a vertex on the hull with the segment outside)
+  if (start == size_t_max) return size_t_max;
+
+  // Walk along the segment, the crossed edge is (right, left)
+  corridor.assign(1, start);
+  corridor_left.clear();
+  corridor_right.clear();
+  corridor_inner.clear();
+
+  // The chains are short, most of the time the search only looks at a few vertices
+  const auto push_side = [&](std::vector<size_t>& chain, size_t s){
+    const auto loop = std::find(chain.rbegin(), chain.rend(), s);
+    if (loop == chain.rend()){
+      chain.push_back(s);
+      return;
+    }
+
+    corridor_inner.insert(corridor_inner.end(), loop.base(), chain.end());
+    chain.erase(loop.base(), chain.end());
+  };
+
+  LocalId<3> edge_id = mesh.triangles[start].local_id_of(a);
+  size_t right = mesh.triangles[start].vertices[edge_id + 1];
+  size_t left = mesh.triangles[start].vertices[edge_id + 2];
+  corridor_right.push_back(right);
+  corridor_left.push_back(left);
+
+  size_t end = size_t_max;
+  tri_id = start;
+  while (end == size_t_max){
+    const MTriangle& tri = mesh.triangles[tri_id];
+    if (tri.is_constrained(edge_id)) return size_t_max;
+
+    const size_t o_tri_id = tri.opposite_triangle[edge_id];
+    const MTriangle& o_tri = mesh.triangles[o_tri_id];
+    if (o_tri.is_infinite()) return size_t_max;
+    corridor.push_back(o_tri_id);
+
+    const size_t s = o_tri.vertices[o_tri.find_edge(right, left)];
+    const TriOrient s_side = s == b ? TriOrient::Flat : side(s);
+
+    // s is b, or a vertex on the segment where the next piece starts
+    if (s_side == TriOrient::Flat)
+      end = s;
+    else if (s_side == TriOrient::CCW){
+      edge_id = o_tri.local_id_of(left);
+      push_side(corridor_left, left = s);
+    }
+    else {
+      edge_id = o_tri.local_id_of(right);
+      push_side(corridor_right, right = s);
+    }
+
+    tri_id = o_tri_id;
+  }
+
+  // The pockets are enclosed by the corridor, they are filled from the triangles around the loop vertices
+  if (!corridor_inner.empty()){
+    std::sort(corridor.begin(), corridor.end());
+    const auto crossed = [&](size_t t){ return std::binary_search(corridor.begin(), corridor.end(), t); };
+
+    std::vector<size_t> pocket, stack;
+    for (size_t v : corridor_inner){
+      const size_t first_tri = mesh.vertex_to_triangle[v];
+      tri_id = first_tri;
+      do {
+        stack.push_back(tri_id);
+        const MTriangle& tri = mesh.triangles[tri_id];
+        tri_id = tri.opposite_triangle[tri.local_id_of(v) + 1];
+      } while (tri_id != first_tri);
+    }
+
+    while (!stack.empty()){
+      const size_t t = stack.back();
+      stack.pop_back();
+      if (crossed(t) || std::find(pocket.begin(), pocket.end(), t) != pocket.end()) continue;
+
+      assert(!mesh.triangles[t].is_infinite());
+      pocket.push_back(t);
+      for (size_t o : mesh.triangles[t].opposite_triangle) stack.push_back(o);
+    }
+
+    // The vertices of the pocket that aren't on a chain are inside
+    const auto on_chain = [&](size_t v){
+      return v == a || v == end
+        || std::find(corridor_left.begin(), corridor_left.end(), v) != corridor_left.end()
+        || std::find(corridor_right.begin(), corridor_right.end(), v) != corridor_right.end();
+    };
+
+    for (size_t t : pocket)
+      for (size_t v : mesh.triangles[t].vertices)
+        if (!on_chain(v) && std::find(corridor_inner.begin(), corridor_inner.end(), v) == corridor_inner.end())
+          corridor_inner.push_back(v);
+
+    corridor.insert(corridor.end(), pocket.begin(), pocket.end());
+    std::sort(corridor.begin(), corridor.end());
+  }
+
+  // Edges of the corridor that aren't crossed by the segment, as seen from the inside.
+  // The edges inside of the corridor are crossed or around an inner vertex, those are inserted again if constrained
+  std::vector<std::pair<size_t, size_t>> inner_constraints;
+  corridor_boundary.clear();
+
+  for (size_t i = 0; i < corridor.size(); i++){
+    const MTriangle& tri = mesh.triangles[corridor[i]];
+    for (int e = 0; e < 3; e++){
+      const size_t outer = tri.opposite_triangle[e];
+      const auto [u, w] = tri.get_edge(e);
+
+      // Walk order, the crossed edges are between consecutive triangles. Sorted order once there are inner vertices
+      const bool inside = corridor_inner.empty()
+        ? (i > 0 && outer == corridor[i - 1]) || (i + 1 < corridor.size() && outer == corridor[i + 1])
+        : std::binary_search(corridor.begin(), corridor.end(), outer);
+
+      if (!inside)
+        corridor_boundary.push_back({ u, w, outer, tri.is_constrained(e) });
+      else if (tri.is_constrained(e) && u < w)
+        inner_constraints.push_back({ u, w });
+    }
+  }
+
+  // A disk of t triangles with i inner vertices has t + 2 - 2i boundary edges
+  const size_t fill_tris = corridor.size() - 2 * corridor_inner.size();
+  assert(corridor_boundary.size() == fill_tris + 2);
+  assert(corridor_left.size() + corridor_right.size() == fill_tris);
+  std::sort(corridor_boundary.begin(), corridor_boundary.end(), [](const CorridorEdge& x, const CorridorEdge& y){
+    return std::pair(x.a, x.b) < std::pair(y.a, y.b);
+  });
+
+  // The two sides take the slots of the corridor
+  insert_stats.constraint_tris += corridor.size();
+  for (size_t v : corridor_inner){
+    sample_grid.erase(mesh, v);
+    mesh.remove_point(v);
+  }
+
+  std::reverse(corridor_right.begin(), corridor_right.end());
+
+  size_t next_slot = 0;
+  const size_t left_tri = fill_pseudo_polygon(a, end, corridor_left, 0, corridor_left.size(), next_slot);
+  const size_t right_tri = fill_pseudo_polygon(end, a, corridor_right, 0, corridor_right.size(), next_slot);
+  assert(next_slot == fill_tris);
+  for (size_t i = fill_tris; i < corridor.size(); i++)
+    mesh.remove_triangle(corridor[i]);
+
+  // Both sides are closed by the segment, edge 2 of their first triangle
+  mesh.triangles[left_tri].opposite_triangle[2] = right_tri;
+  mesh.triangles[right_tri].opposite_triangle[2] = left_tri;
+  mesh.triangles[left_tri].set_constrained(2, true);
+  mesh.triangles[right_tri].set_constrained(2, true);
+  locate_hint = left_tri;
+  assert_triangle_mesh_valid(mesh);
+
+  // The inner vertices take their ids back, they are distinct points so none is found as a copy
+  if (!corridor_inner.empty()){
+    const std::vector<size_t> inner = corridor_inner;
+    for (size_t v : inner){
+      mesh.reuse_next(v);
+      [[maybe_unused]] const size_t vertex = add_point(Vector(mesh.vertices[v]));
+      assert(vertex == v);
+    }
+
+    for (const auto& [u, w] : inner_constraints)
+      insert_constraint(u, w);
+  }
+
+  return end;
+}
+
+size_t DelaunayTriangulation2D::fill_pseudo_polygon(size_t u, size_t w, const std::vector<size_t>& chain, size_t first, size_t last, size_t& next_slot){
+  assert(first < last);
+  const Vector& pu = mesh.vertices[u];
+  const Vector& pw = mesh.vertices[w];
+
+  // The circles through u and w are nested on the side of the chain, the smallest one is empty
+  size_t c = first;
+  for (size_t j = first + 1; j < last; j++)
+    if (in_circle_2d({ pu, pw, mesh.vertices[chain[c]] }, mesh.vertices[chain[j]]) > 0)
+      c = j;
+
+  const size_t v = chain[c];
+  const size_t slot = corridor[next_slot++];
+  MTriangle& tri = mesh.triangles[slot];
+  tri.vertices = { u, w, v };
+  tri.constraints = 0;
+  mesh.vertex_to_triangle[u] = mesh.vertex_to_triangle[w] = mesh.vertex_to_triangle[v] = slot;
+
+  // Edge 0 (w, v) closes the chain after c, edge 1 (v, u) the chain before c.
+  // An empty chain leaves an edge of the corridor
+  const auto close = [&](LocalId<3> edge_id, size_t x, size_t y, size_t sub_first, size_t sub_last){
+    if (sub_first < sub_last){
+      const size_t sub = fill_pseudo_polygon(y, x, chain, sub_first, sub_last, next_slot);
+      tri.opposite_triangle[edge_id] = sub;
+      mesh.triangles[sub].opposite_triangle[2] = slot;
+      return;
+    }
+
+    const auto edge = std::lower_bound(corridor_boundary.begin(), corridor_boundary.end(), std::pair(x, y),
+      [](const CorridorEdge& e, const std::pair<size_t, size_t>& key){ return std::pair(e.a, e.b) < key; });
+    assert(edge != corridor_boundary.end() && edge->a == x && edge->b == y);
+
+    MTriangle& outer = mesh.triangles[edge->outer];
+    outer.opposite_triangle[outer.find_edge(x, y)] = slot;
+    tri.opposite_triangle[edge_id] = edge->outer;
+    tri.set_constrained(edge_id, edge->constrained);
+  };
+
+  close(0, w, v, c + 1, last);
+  close(1, v, u, first, c);
+  return slot;
+}
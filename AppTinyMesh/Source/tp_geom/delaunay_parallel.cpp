@@ -0,0 +1,599 @@
+#include <tp_geom/delaunay.h>
+#include <tp_geom/delaunay_3d.h>
+#include <tp_geom/seam_stitch.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Parallel construction :
+// - the cloud is cut in kd cells, each one is triangulated on its own
+// - a triangle of a cell whose circumcircle stays inside the cell is empty for the whole cloud,
+//   it is kept as is ("certified")
+// - the vertices of the other triangles make the seam, which is triangulated again. Its triangles
+//   fill the holes left between the certified ones, the holes are bounded by the edges shared
+//   by a certified and a non certified triangle of a cell
+// The 3d build is the same with tets and circumspheres, its holes are bounded by faces
+
+namespace {
+  using InsertStats = DelaunayTriangulation2D::InsertStats;
+  constexpr double inf = std::numeric_limits<double>::infinity();
+
+  // Part of the plane (or of the space) owned by a piece, unbounded on the outer sides
+  struct Cell {
+    std::array<double, 3> min{ -inf, -inf, -inf };
+    std::array<double, 3> max{ inf, inf, inf };
+    size_t begin = 0, end = 0; // Range of its points in the order array
+  };
+
+  struct Piece {
+    TriangleMesh mesh;
+    InsertStats stats;
+    std::vector<size_t> to_global;  // Local vertex -> vertex of the merged mesh
+    std::vector<size_t> tri_global; // Local triangle -> triangle of the merged mesh, size_t_max if not certified
+    std::vector<char> certified;
+    bool valid = false;
+  };
+
+  // Splits the cells near the median of their longest side (among the dims first axes) until there are
+  // enough of them. The side and the median are estimated on a sample, it saves a nth_element on the whole cell
+  std::vector<Cell> kd_cells(const std::vector<Vector>& points, std::vector<size_t>& order, size_t pieces, int dims){
+    constexpr size_t sample_size = 1024;
+
+    std::vector<Cell> cells(1);
+    cells[0].end = order.size();
+
+    while (cells.size() < pieces){
+      std::vector<Cell> next(2 * cells.size());
+
+      #pragma omp parallel for
+      for (long c = 0; c < long(cells.size()); c++){
+        const Cell& cell = cells[c];
+        const size_t step = std::max<size_t>(1, (cell.end - cell.begin) / sample_size);
+        std::vector<size_t> sample;
+        for (size_t i = cell.begin; i < cell.end; i += step)
+          sample.push_back(order[i]);
+
+        std::array<double, 3> min{ inf, inf, inf }, max{ -inf, -inf, -inf };
+        for (size_t i : sample)
+          for (int k = 0; k < dims; k++){
+            min[k] = std::min(min[k], points[i][k]);
+            max[k] = std::max(max[k], points[i][k]);
+          }
+
+        int axis = 0;
+        for (int k = 1; k < dims; k++)
+          if (max[k] - min[k] > max[axis] - min[axis]) axis = k;
+        const auto less = [&](size_t a, size_t b){ return points[a][axis] < points[b][axis]; };
+        std::nth_element(sample.begin(), sample.begin() + sample.size() / 2, sample.end(), less);
+        double split = points[sample[sample.size() / 2]][axis];
+
+        auto mid = std::partition(order.begin() + cell.begin, order.begin() + cell.end,
+          [&](size_t i){ return points[i][axis] < split; });
+
+        // Many points on the split line, cut exactly at the median instead
+        if (mid == order.begin() + cell.begin || mid == order.begin() + cell.end){
+          mid = order.begin() + (cell.begin + cell.end) / 2;
+          std::nth_element(order.begin() + cell.begin, mid, order.begin() + cell.end, less);
+          split = points[*mid][axis];
+        }
+
+        // Points on the split line may be on both sides, the circumcircles can't touch it anyway
+        Cell low = cell, high = cell;
+        low.end = high.begin = mid - order.begin();
+        low.max[axis] = split;
+        high.min[axis] = split;
+
+        next[2 * c] = low;
+        next[2 * c + 1] = high;
+      }
+
+      cells = std::move(next);
+    }
+
+    return cells;
+  }
+
+  bool circumcircle_inside(const std::array<Vector, 3>& tri, const Cell& cell){
+    SeamStitch::Circle circle;
+    return SeamStitch::circumcircle(tri, circle) && circle.inside(cell.min[0], cell.min[1], cell.max[0], cell.max[1]);
+  }
+
+  // Returns false if the seam couldn't be stitched (degenerated pieces, cocircular points split
+  // differently by a piece and the seam, copies of a point in two pieces), the caller falls back to the serial build.
+  // ids is the vertex of each point : i + 1, or the one of the first copy in its piece
+  bool build_by_pieces(const std::vector<Vector>& points, size_t pieces, DelaunayTriangulation2D::Kernel kernel,
+                       TriangleMesh& out, InsertStats& stats, std::vector<size_t>& ids){
+    std::vector<size_t> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    const std::vector<Cell> cells = kd_cells(points, order, pieces, 2);
+
+    std::vector<Piece> parts(cells.size());
+    std::vector<char> in_seam(points.size() + TriangleMesh::v_start_offset, 0);
+    ids.assign(points.size(), size_t_max);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long c = 0; c < long(cells.size()); c++){
+      const Cell& cell = cells[c];
+      Piece& part = parts[c];
+
+      std::vector<Vector> cell_points(cell.end - cell.begin);
+      for (size_t i = 0; i < cell_points.size(); i++)
+        cell_points[i] = points[order[cell.begin + i]];
+
+      DelaunayTriangulation2D tri(kernel);
+      const std::vector<size_t> local_ids = tri.build(cell_points);
+      part.stats = tri.get_insert_stats();
+      part.mesh = tri.extract_mesh();
+
+      const TriangleMesh& m = part.mesh;
+      if (m.triangles.empty()) continue;
+
+      // The copies of a point share its local vertex, the first one gives the global vertex
+      part.to_global.assign(m.vertices.size(), TriangleMesh::infinite_point);
+      for (size_t i = 0; i < local_ids.size(); i++){
+        size_t& global = part.to_global[local_ids[i]];
+        if (global == TriangleMesh::infinite_point) global = order[cell.begin + i] + TriangleMesh::v_start_offset;
+        ids[order[cell.begin + i]] = global;
+      }
+
+      part.certified.resize(m.triangles.size());
+      for (size_t t = 0; t < m.triangles.size(); t++){
+        const MTriangle& mt = m.triangles[t];
+        part.certified[t] = !mt.is_infinite() && circumcircle_inside(m.get_vertices(mt), cell);
+
+        // Each vertex belongs to one piece, no other thread writes it
+        if (!part.certified[t])
+          for (size_t v : mt.vertices)
+            in_seam[part.to_global[v]] = 1;
+      }
+
+      part.valid = true;
+    }
+
+    for (const Piece& part : parts){
+      if (!part.valid) return false;
+      stats += part.stats;
+    }
+
+    // Triangulation of the seam
+    std::vector<size_t> seam_vertices;
+    for (size_t v = TriangleMesh::v_start_offset; v < in_seam.size(); v++)
+      if (in_seam[v]) seam_vertices.push_back(v);
+
+    std::vector<Vector> seam_points(seam_vertices.size());
+    for (size_t i = 0; i < seam_vertices.size(); i++)
+      seam_points[i] = points[seam_vertices[i] - TriangleMesh::v_start_offset];
+
+    // Copies in two pieces are two vertices of the merged mesh, the seam would make them one
+    DelaunayTriangulation2D seam_tri(kernel);
+    const std::vector<size_t> seam_ids = seam_tri.build(seam_points);
+    if (seam_tri.get_insert_stats().duplicates > 0) return false;
+    stats += seam_tri.get_insert_stats();
+
+    TriangleMesh seam = seam_tri.extract_mesh();
+    if (seam.triangles.empty()) return false;
+
+    std::vector<size_t> seam_to_global(seam.vertices.size(), TriangleMesh::infinite_point);
+    std::vector<size_t> global_to_seam(in_seam.size(), size_t_max);
+    for (size_t i = 0; i < seam_ids.size(); i++){
+      seam_to_global[seam_ids[i]] = seam_vertices[i];
+      global_to_seam[seam_vertices[i]] = seam_ids[i];
+    }
+
+    // Numbering of the merged triangles : the certified ones piece by piece, the seam ones follow
+    size_t tri_count = 0;
+    for (Piece& part : parts){
+      part.tri_global.assign(part.mesh.triangles.size(), size_t_max);
+      for (size_t t = 0; t < part.mesh.triangles.size(); t++)
+        if (part.certified[t]) part.tri_global[t] = tri_count++;
+    }
+
+    out = TriangleMesh();
+    out.vertices.insert(out.vertices.end(), points.begin(), points.end());
+    TriangleMesh::check_size(out.vertices.size(), tri_count);
+    out.triangles.resize(tri_count);
+
+    // The edges toward a non certified triangle stay open, the seam fills them
+    #pragma omp parallel for schedule(dynamic)
+    for (long c = 0; c < long(parts.size()); c++){
+      const Piece& part = parts[c];
+      for (size_t t = 0; t < part.mesh.triangles.size(); t++){
+        if (!part.certified[t]) continue;
+        const MTriangle& local = part.mesh.triangles[t];
+        MTriangle& tri = out.triangles[part.tri_global[t]];
+
+        for (int i = 0; i < 3; i++){
+          tri.vertices[i] = part.to_global[local.vertices[i]];
+          tri.opposite_triangle[i] = part.tri_global[local.opposite_triangle[i]];
+        }
+      }
+    }
+
+    if (!SeamStitch::fill_holes(out, seam, seam_to_global, global_to_seam)) return false;
+
+    // The other copies are free vertices, no triangle uses them
+    for (size_t i = 0; i < points.size(); i++)
+      if (ids[i] != i + TriangleMesh::v_start_offset) out.free_vertices.push_back(i + TriangleMesh::v_start_offset);
+
+    assert_triangle_mesh_valid(out);
+    return true;
+  }
+
+  size_t default_pieces(){
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+}
+
+std::vector<size_t> DelaunayTriangulation2D::build_parallel(const std::vector<Vector>& points, size_t pieces){
+  // Below this size per piece, the seam is a large part of the work
+  constexpr size_t min_piece_size = 4096;
+
+  if (pieces == 0)
+    pieces = default_pieces();
+
+  if (mesh.vertices.size() > TriangleMesh::v_start_offset || pieces < 2 || points.size() < pieces * min_piece_size)
+    return build(points);
+
+  TriangleMesh merged;
+  InsertStats stats;
+  std::vector<size_t> ids;
+  if (!build_by_pieces(points, pieces, kernel, merged, stats, ids))
+    return build(points);
+
+  mesh = std::move(merged);
+  insert_stats += stats;
+
+  locate_hint = 0;
+  sample_grid.assign(mesh);
+  return ids;
+}
+
+namespace {
+  struct TetPiece {
+    TetMesh mesh;
+    DelaunayTriangulation3D::InsertStats stats;
+    std::vector<size_t> to_global;  // Local vertex -> vertex of the merged mesh
+    std::vector<size_t> tet_global; // Local tet -> tet of the merged mesh, size_t_max if not certified
+    std::vector<char> certified;
+    bool valid = false;
+  };
+
+  // Open face of a certified tet, it is also a face of the seam tetrahedralization
+  struct SeamFace {
+    size_t tet;
+    int face;
+    size_t inner = size_t_max;    // Seam tet on the side of the certified one
+    int inner_face = 0;
+    size_t seam_tet = size_t_max; // Seam tet on the other side
+    int seam_face = 0;
+  };
+
+  // Vertices of the face i of a tet, sorted, and the parity of its orientation seen from the tet.
+  // The two tets of a face see it with opposite parities (the shift by i of the vertices is odd for an odd i)
+  using FaceKey = std::array<size_t, 3>;
+
+  template <class Ids>
+  bool face_key(const MTet& tet, int i, const Ids& ids, FaceKey& key){
+    key = { ids(tet.vertices[(i + 1) & 3]), ids(tet.vertices[(i + 2) & 3]), ids(tet.vertices[(i + 3) & 3]) };
+    bool parity = i & 1;
+    for (int a = 0; a < 2; a++)
+      for (int b = 0; b < 2 - a; b++)
+        if (key[b] > key[b + 1]){
+          std::swap(key[b], key[b + 1]);
+          parity = !parity;
+        }
+    return parity;
+  }
+
+  struct FaceKeyHash {
+    size_t operator()(const FaceKey& key) const {
+      return (key[0] * 0x9E3779B97F4A7C15ull) ^ (key[1] * 0xC2B2AE3D27D4EB4Full) ^ (key[2] * 0x165667B19E3779F9ull);
+    }
+  };
+
+  // The radius is slightly bigger, as SeamStitch::circumcircle : a false negative only makes the seam a bit larger
+  bool circumsphere_inside(const std::array<Vector, 4>& tet, const Cell& cell){
+    const double bx = tet[1][0] - tet[0][0], by = tet[1][1] - tet[0][1], bz = tet[1][2] - tet[0][2];
+    const double cx = tet[2][0] - tet[0][0], cy = tet[2][1] - tet[0][1], cz = tet[2][2] - tet[0][2];
+    const double dx = tet[3][0] - tet[0][0], dy = tet[3][1] - tet[0][1], dz = tet[3][2] - tet[0][2];
+
+    // c x d, d x b, b x c
+    const double cdx = cy * dz - cz * dy, cdy = cz * dx - cx * dz, cdz = cx * dy - cy * dx;
+    const double dbx = dy * bz - dz * by, dby = dz * bx - dx * bz, dbz = dx * by - dy * bx;
+    const double bcx = by * cz - bz * cy, bcy = bz * cx - bx * cz, bcz = bx * cy - by * cx;
+
+    const double d = 2 * (bx * cdx + by * cdy + bz * cdz);
+    if (!(d != 0)) return false;
+
+    const double b2 = bx * bx + by * by + bz * bz, c2 = cx * cx + cy * cy + cz * cz, d2 = dx * dx + dy * dy + dz * dz;
+    const std::array<double, 3> u = { (b2 * cdx + c2 * dbx + d2 * bcx) / d,
+                                      (b2 * cdy + c2 * dby + d2 * bcy) / d,
+                                      (b2 * cdz + c2 * dbz + d2 * bcz) / d };
+    const double r = std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]) * (1 + 1e-6);
+
+    for (int k = 0; k < 3; k++){
+      const double center = tet[0][k] + u[k];
+      if (!(center - r > cell.min[k] && center + r < cell.max[k])) return false;
+    }
+    return true;
+  }
+
+  // SeamStitch::fill_holes with tets : the seam tets covering the certified ones are dropped, the others
+  // are added to out and linked to the open faces. The open faces are found in the seam by their vertices
+  bool fill_tet_holes(TetMesh& out, const TetMesh& seam, const std::vector<size_t>& seam_to_global,
+                      const std::vector<size_t>& global_to_seam){
+    const size_t kept_count = out.tets.size();
+    const auto to_seam = [&](size_t v){ return global_to_seam[v]; };
+    const auto same = [](size_t v){ return v; };
+
+    std::vector<SeamFace> faces;
+    for (size_t t = 0; t < kept_count; t++)
+      for (int f = 0; f < 4; f++)
+        if (out.tets[t].opposite_tet[f] == size_t_max)
+          faces.push_back({ t, f });
+
+    std::unordered_map<FaceKey, size_t, FaceKeyHash> face_ids;
+    std::vector<char> parities(faces.size());
+    face_ids.reserve(faces.size());
+    for (size_t i = 0; i < faces.size(); i++){
+      FaceKey key;
+      parities[i] = face_key(out.tets[faces[i].tet], faces[i].face, to_seam, key);
+      if (key[2] == size_t_max || !face_ids.insert({ key, i }).second) return false;
+    }
+
+    // Each face of the seam is in two tets, with opposite parities : one writer per field
+    #pragma omp parallel for
+    for (long s = 0; s < long(seam.tets.size()); s++){
+      const MTet& tet = seam.tets[s];
+      if (tet.is_free()) continue;
+
+      for (int i = 0; i < 4; i++){
+        FaceKey key;
+        const bool parity = face_key(tet, i, same, key);
+        const auto it = face_ids.find(key);
+        if (it == face_ids.end()) continue;
+        SeamFace& face = faces[it->second];
+        if (parity == parities[it->second]){
+          face.inner = s;
+          face.inner_face = i;
+        } else {
+          face.seam_tet = s;
+          face.seam_face = i;
+        }
+      }
+    }
+
+    for (const SeamFace& face : faces)
+      if (face.inner == size_t_max || face.seam_tet == size_t_max) return false;
+
+    // The seam tets covering the certified areas are dropped
+    std::vector<char> boundary(seam.tets.size(), 0); // Bit f set when face f is a certified area boundary
+    std::vector<char> removed(seam.tets.size(), 0);
+    std::vector<size_t> to_remove;
+
+    for (size_t s = 0; s < seam.tets.size(); s++)
+      removed[s] = seam.tets[s].is_free();
+
+    for (const SeamFace& face : faces){
+      boundary[face.inner] |= 1 << face.inner_face;
+      boundary[face.seam_tet] |= 1 << face.seam_face;
+
+      if (!removed[face.inner]){
+        removed[face.inner] = 1;
+        to_remove.push_back(face.inner);
+      }
+    }
+
+    while (!to_remove.empty()){
+      const size_t t = to_remove.back();
+      to_remove.pop_back();
+      if (seam.tets[t].is_infinite()) return false;
+
+      for (int f = 0; f < 4; f++){
+        const size_t o = seam.tets[t].opposite_tet[f];
+        if (boundary[t] & (1 << f) || removed[o]) continue;
+        removed[o] = 1;
+        to_remove.push_back(o);
+      }
+    }
+
+    for (const SeamFace& face : faces)
+      if (removed[face.seam_tet]) return false;
+
+    // The seam tets follow the certified ones
+    size_t tet_count = kept_count;
+    std::vector<size_t> seam_global(seam.tets.size(), size_t_max);
+    for (size_t s = 0; s < seam.tets.size(); s++)
+      if (!removed[s]) seam_global[s] = tet_count++;
+
+    TetMesh::check_size(out.vertices.size(), tet_count);
+    out.tets.resize(tet_count);
+
+    #pragma omp parallel for
+    for (long s = 0; s < long(seam.tets.size()); s++){
+      if (removed[s]) continue;
+      const MTet& local = seam.tets[s];
+      MTet& tet = out.tets[seam_global[s]];
+
+      for (int i = 0; i < 4; i++){
+        tet.vertices[i] = seam_to_global[local.vertices[i]];
+        tet.opposite_tet[i] = seam_global[local.opposite_tet[i]];
+      }
+    }
+
+    for (const SeamFace& face : faces){
+      const size_t from_seam = seam_global[face.seam_tet];
+      out.tets[face.tet].opposite_tet[face.face] = from_seam;
+      out.tets[from_seam].opposite_tet[face.seam_face] = face.tet;
+    }
+
+    out.vertex_to_tet.assign(out.vertices.size(), size_t_max);
+
+    bool linked = true;
+    #pragma omp parallel for reduction(&&: linked)
+    for (long t = 0; t < long(out.tets.size()); t++){
+      const MTet& tet = out.tets[t];
+      for (int i = 0; i < 4; i++){
+        linked = linked && tet.opposite_tet[i] != size_t_max;
+        #pragma omp atomic write
+        out.vertex_to_tet[tet.vertices[i]] = t;
+      }
+    }
+
+    return linked;
+  }
+
+  // As build_by_pieces, with tets. Returns false if the seam couldn't be stitched (flat or degenerated pieces,
+  // cospherical points split differently by a piece and the seam, copies of a point in two pieces)
+  bool build_tets_by_pieces(const std::vector<Vector>& points, size_t pieces, TetMesh& out,
+                            DelaunayTriangulation3D::InsertStats& stats, std::vector<size_t>& ids){
+    std::vector<size_t> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    const std::vector<Cell> cells = kd_cells(points, order, pieces, 3);
+
+    std::vector<TetPiece> parts(cells.size());
+    std::vector<char> in_seam(points.size() + TetMesh::v_start_offset, 0);
+    ids.assign(points.size(), size_t_max);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long c = 0; c < long(cells.size()); c++){
+      const Cell& cell = cells[c];
+      TetPiece& part = parts[c];
+
+      std::vector<Vector> cell_points(cell.end - cell.begin);
+      for (size_t i = 0; i < cell_points.size(); i++)
+        cell_points[i] = points[order[cell.begin + i]];
+
+      DelaunayTriangulation3D tri;
+      const std::vector<size_t> local_ids = tri.build(cell_points);
+      part.stats = tri.get_insert_stats();
+      part.mesh = tri.extract_mesh();
+
+      const TetMesh& m = part.mesh;
+      if (m.tets.empty()) continue;
+
+      // The copies of a point share its local vertex, the first one gives the global vertex
+      part.to_global.assign(m.vertices.size(), TetMesh::infinite_point);
+      for (size_t i = 0; i < local_ids.size(); i++){
+        size_t& global = part.to_global[local_ids[i]];
+        if (global == TetMesh::infinite_point) global = order[cell.begin + i] + TetMesh::v_start_offset;
+        ids[order[cell.begin + i]] = global;
+      }
+
+      part.certified.assign(m.tets.size(), 0);
+      for (size_t t = 0; t < m.tets.size(); t++){
+        const MTet& mt = m.tets[t];
+        if (mt.is_free()) continue;
+        part.certified[t] = !mt.is_infinite() && circumsphere_inside(m.get_vertices(mt), cell);
+
+        // Each vertex belongs to one piece, no other thread writes it
+        if (!part.certified[t])
+          for (size_t v : mt.vertices)
+            in_seam[part.to_global[v]] = 1;
+      }
+
+      part.valid = true;
+    }
+
+    for (const TetPiece& part : parts){
+      if (!part.valid) return false;
+      stats += part.stats;
+    }
+
+    // Tetrahedralization of the seam
+    std::vector<size_t> seam_vertices;
+    for (size_t v = TetMesh::v_start_offset; v < in_seam.size(); v++)
+      if (in_seam[v]) seam_vertices.push_back(v);
+
+    std::vector<Vector> seam_points(seam_vertices.size());
+    for (size_t i = 0; i < seam_vertices.size(); i++)
+      seam_points[i] = points[seam_vertices[i] - TetMesh::v_start_offset];
+
+    // Copies in two pieces are two vertices of the merged mesh, the seam would make them one
+    DelaunayTriangulation3D seam_tri;
+    const std::vector<size_t> seam_ids = seam_tri.build(seam_points);
+    if (seam_tri.get_insert_stats().duplicates > 0) return false;
+    stats += seam_tri.get_insert_stats();
+
+    TetMesh seam = seam_tri.extract_mesh();
+    if (seam.tets.empty()) return false;
+
+    std::vector<size_t> seam_to_global(seam.vertices.size(), TetMesh::infinite_point);
+    std::vector<size_t> global_to_seam(in_seam.size(), size_t_max);
+    global_to_seam[TetMesh::infinite_point] = TetMesh::infinite_point;
+    for (size_t i = 0; i < seam_ids.size(); i++){
+      seam_to_global[seam_ids[i]] = seam_vertices[i];
+      global_to_seam[seam_vertices[i]] = seam_ids[i];
+    }
+
+    // Numbering of the merged tets : the certified ones piece by piece, the seam ones follow
+    size_t tet_count = 0;
+    for (TetPiece& part : parts){
+      part.tet_global.assign(part.mesh.tets.size(), size_t_max);
+      for (size_t t = 0; t < part.mesh.tets.size(); t++)
+        if (part.certified[t]) part.tet_global[t] = tet_count++;
+    }
+
+    out = TetMesh();
+    out.vertices.insert(out.vertices.end(), points.begin(), points.end());
+    TetMesh::check_size(out.vertices.size(), tet_count);
+    // Room for the seam tets too, growing this vector later would copy it whole
+    out.tets.reserve(tet_count + seam.tets.size());
+    out.tets.resize(tet_count);
+
+    // The faces toward a non certified tet stay open, the seam fills them.
+    // A piece is released once copied, the merged mesh and the pieces are not both held whole
+    #pragma omp parallel for schedule(dynamic)
+    for (long c = 0; c < long(parts.size()); c++){
+      TetPiece& part = parts[c];
+      for (size_t t = 0; t < part.mesh.tets.size(); t++){
+        if (!part.certified[t]) continue;
+        const MTet& local = part.mesh.tets[t];
+        MTet& tet = out.tets[part.tet_global[t]];
+
+        for (int i = 0; i < 4; i++){
+          tet.vertices[i] = part.to_global[local.vertices[i]];
+          tet.opposite_tet[i] = part.tet_global[local.opposite_tet[i]];
+        }
+      }
+      part = TetPiece();
+    }
+
+    if (!fill_tet_holes(out, seam, seam_to_global, global_to_seam)) return false;
+
+    assert_tet_mesh_valid(out);
+    return true;
+  }
+}
+
+std::vector<size_t> DelaunayTriangulation3D::build_parallel(const std::vector<Vector>& points, size_t pieces){
+  // Below this size per piece, the seam is a large part of the work
+  constexpr size_t min_piece_size = 4096;
+
+  if (pieces == 0)
+    pieces = default_pieces();
+
+  if (mesh.vertices.size() > TetMesh::v_start_offset || pieces < 2 || points.size() < pieces * min_piece_size)
+    return build(points);
+
+  TetMesh merged;
+  InsertStats stats;
+  std::vector<size_t> ids;
+  if (!build_tets_by_pieces(points, pieces, merged, stats, ids))
+    return build(points);
+
+  mesh = std::move(merged);
+  insert_stats += stats;
+
+  tet_state.assign(mesh.tets.capacity(), Unknown);
+  locate_hint = 0;
+  return ids;
+}
@@ -0,0 +1,287 @@
+#include <tp_geom/delaunay.h>
+#include <tp_geom/algo.h>
+#include <cmath>
+#include <queue>
+
+// Delaunay refinement (Ruppert) :
+// - a segment is encroached when a vertex is inside of its diametral circle, it is split in two.
+//   In a constrained Delaunay triangulation only the apexes of the segment have to be looked at
+// - a bad triangle gets a vertex at its circumcenter. If this vertex encroaches segments it is
+//   removed again and the segments are split instead
+// The encroached segments go first. After an insertion only the star of the new vertex is checked,
+// the queue isn't rebuilt : its entries keep the vertices of their triangle, the triangles rewritten
+// since are dropped when they come out. The queue is a list of FIFO buckets of quality (as in Shewchuk's
+// Triangle), the worst bucket comes first. Unlike a heap it keeps the order of the insertions inside of
+// a bucket, consecutive triangles are close in the mesh and in memory.
+// Around a small input angle the segments would be split without end. They are split on concentric
+// shells (powers of 2) around the input vertex, the triangles between two shells of the same radius are left
+
+namespace {
+  struct BadTri {
+    size_t tri_id;
+    std::array<MTriangle::Id, 3> vertices;
+  };
+
+  // Buckets of quality, the last one holds the triangles that are only too large
+  class BadQueue {
+  public:
+    static constexpr int quality_buckets = 16;
+
+    BadQueue(double min_quality): min_quality(min_quality) {}
+
+    void push(double quality, const BadTri& tri){
+      const int bucket = quality < min_quality ? int(quality / min_quality * quality_buckets) : quality_buckets;
+      buckets[bucket].push(tri);
+      first = std::min(first, bucket);
+    }
+
+    bool empty(){
+      while (first <= quality_buckets && buckets[first].empty()) first++;
+      return first > quality_buckets;
+    }
+
+    BadTri pop(){
+      const BadTri tri = buckets[first].front();
+      buckets[first].pop();
+      return tri;
+    }
+
+  private:
+    double min_quality;
+    std::array<std::queue<BadTri>, quality_buckets + 1> buckets;
+    int first = quality_buckets + 1;
+  };
+
+  struct Encroached {
+    size_t u, w;
+    bool forced; // Encroached by a point that wasn't inserted, the apexes don't tell it
+  };
+
+  struct Shape {
+    double quality; // Squared sine of the smallest angle
+    double area;
+    int shortest;   // Shortest edge
+  };
+
+  // The smallest angle is between the two longest edges, their cross product is l_mid * l_max * sin
+  Shape triangle_shape(const std::array<Vector, 3>& p){
+    std::array<double, 3> l2;
+    for (int i = 0; i < 3; i++)
+      l2[i] = squared_distance_2d(p[(i + 1) % 3], p[(i + 2) % 3]);
+
+    const int shortest = l2[0] < l2[1] ? (l2[0] < l2[2] ? 0 : 2) : (l2[1] < l2[2] ? 1 : 2);
+    const double cross = (p[1][0] - p[0][0]) * (p[2][1] - p[0][1]) - (p[1][1] - p[0][1]) * (p[2][0] - p[0][0]);
+    return { cross * cross / (l2[(shortest + 1) % 3] * l2[(shortest + 2) % 3]), std::abs(cross) / 2, shortest };
+  }
+}
+
+size_t DelaunayTriangulation2D::split_segment(size_t tri_id, LocalId<3> edge_id, const Vector& point){
+  insert_stats.inserts++;
+  const size_t point_id = TriMeshAlgorithm::split_edge(mesh, tri_id, edge_id, point);
+  sample_grid.insert(mesh, point_id);
+  restore_delaunay_around(point_id);
+  locate_hint = mesh.vertex_to_triangle[point_id];
+  return point_id;
+}
+
+DelaunayTriangulation2D::RefineStats DelaunayTriangulation2D::refine(const RefineCriteria& criteria){
+  RefineStats stats;
+  if (mesh.triangles.empty()) return stats;
+
+  const double sin_min = std::sin(Math::DegreeToRadian(criteria.min_angle));
+  const double min_quality = sin_min * sin_min;
+  constexpr std::pair<size_t, size_t> no_segment = { size_t_max, size_t_max };
+
+  // Input segment holding each point inserted on a segment, as (lowest id, highest id)
+  std::vector<std::pair<size_t, size_t>> on_segment(mesh.vertices.size(), no_segment);
+  BadQueue bad(min_quality);
+  std::vector<Encroached> encroached;
+  std::vector<size_t> link;
+
+  const auto is_segment = [&](const MTriangle& tri, LocalId<3> e){
+    return tri.is_constrained(e) || mesh.triangles[tri.opposite_triangle[e]].is_infinite();
+  };
+
+  const auto apex_encroaches = [&](const MTriangle& tri, LocalId<3> e){
+    const Vector& apex = mesh.get_vertex(tri, e);
+    const Vector u = mesh.get_vertex(tri, e + 1) - apex, w = mesh.get_vertex(tri, e + 2) - apex;
+    return u[0] * w[0] + u[1] * w[1] < 0;
+  };
+
+  const auto check_triangle = [&](size_t tri_id){
+    const MTriangle& tri = mesh.triangles[tri_id];
+    if (tri.is_infinite()) return;
+
+    for (int e = 0; e < 3; e++)
+      if (is_segment(tri, e) && apex_encroaches(tri, e)){
+        const auto [u, w] = tri.get_edge(e);
+        encroached.push_back({ u, w, false });
+      }
+
+    const Shape shape = triangle_shape(mesh.get_vertices(tri));
+    if (shape.quality < min_quality || shape.area > criteria.max_area)
+      bad.push(shape.quality, { tri_id, tri.vertices });
+  };
+
+  const auto check_star = [&](size_t vertex){
+    const size_t start = mesh.vertex_to_triangle[vertex];
+    size_t tri_id = start;
+    do {
+      check_triangle(tri_id);
+      const MTriangle& tri = mesh.triangles[tri_id];
+      tri_id = tri.opposite_triangle[tri.local_id_of(vertex) + 1];
+    } while (tri_id != start);
+  };
+
+  // Finite triangle holding the edge (u, w) on one of its sides, size_t_max if the edge is gone
+  const auto find_edge = [&](size_t u, size_t w) -> std::pair<size_t, LocalId<3>> {
+    if (mesh.is_free_vertex(u)) return { size_t_max, 0 };
+
+    const size_t start = mesh.vertex_to_triangle[u];
+    size_t tri_id = start;
+    do {
+      const MTriangle& tri = mesh.triangles[tri_id];
+      const LocalId<3> id = tri.local_id_of(u);
+      if (tri.vertices[id + 1] == w){
+        if (!tri.is_infinite()) return { tri_id, id + 2 };
+        const size_t o_tri_id = tri.opposite_triangle[id + 2];
+        return { o_tri_id, mesh.triangles[o_tri_id].find_edge(u, w) };
+      }
+      tri_id = tri.opposite_triangle[id + 1];
+    } while (tri_id != start);
+
+    return { size_t_max, 0 };
+  };
+
+  // Both ends of the edge are on segments leaving the same input vertex, at the same distance from it
+  const auto in_small_angle = [&](size_t p, size_t q){
+    const auto sp = on_segment[p], sq = on_segment[q];
+    if (sp == no_segment || sq == no_segment || sp == sq) return false;
+
+    const size_t apex = sp.first == sq.first || sp.first == sq.second ? sp.first
+                      : sp.second == sq.first || sp.second == sq.second ? sp.second : size_t_max;
+    if (apex == size_t_max) return false;
+
+    const double dp = squared_distance_2d(mesh.vertices[p], mesh.vertices[apex]);
+    const double dq = squared_distance_2d(mesh.vertices[q], mesh.vertices[apex]);
+    return std::abs(dp - dq) <= 1e-6 * std::max(dp, dq);
+  };
+
+  const auto split = [&](const Encroached& segment){
+    const auto [tri_id, edge_id] = find_edge(segment.u, segment.w);
+    if (tri_id == size_t_max) return;
+
+    const MTriangle& tri = mesh.triangles[tri_id];
+    if (!is_segment(tri, edge_id)) return;
+
+    if (!segment.forced){
+      const size_t o_tri_id = tri.opposite_triangle[edge_id];
+      const MTriangle& o_tri = mesh.triangles[o_tri_id];
+      if (!apex_encroaches(tri, edge_id) && (o_tri.is_infinite() || !apex_encroaches(o_tri, o_tri.find_edge(segment.u, segment.w))))
+        return;
+    }
+
+    // Midpoint, or the power of 2 closest to it when a single end is an input vertex
+    const auto [u, w] = tri.get_edge(edge_id);
+    const bool u_input = on_segment[u] == no_segment, w_input = on_segment[w] == no_segment;
+    double t = 0.5;
+    if (u_input != w_input){
+      const double length = std::sqrt(squared_distance_2d(mesh.vertices[u], mesh.vertices[w]));
+      const double shell = std::exp2(std::round(std::log2(length / 2)));
+      t = u_input ? shell / length : 1 - shell / length;
+    }
+
+    const std::pair<size_t, size_t> input = !u_input ? on_segment[u] : !w_input ? on_segment[w] : std::pair(std::min(u, w), std::max(u, w));
+    const Vector point = mesh.vertices[u] + (mesh.vertices[w] - mesh.vertices[u]) * t;
+
+    const size_t vertex = split_segment(tri_id, edge_id, point);
+    on_segment.resize(mesh.vertices.size(), no_segment);
+    on_segment[vertex] = input;
+    stats.segment_splits++;
+    check_star(vertex);
+  };
+
+  for (size_t t = 0; t < mesh.triangles.size(); t++)
+    if (!mesh.triangles[t].is_free())
+      check_triangle(t);
+
+  while (stats.steiner() < criteria.max_steiner){
+    if (!encroached.empty()){
+      const Encroached segment = encroached.back();
+      encroached.pop_back();
+      split(segment);
+      continue;
+    }
+
+    if (bad.empty()) break;
+    const BadTri entry = bad.pop();
+
+    const MTriangle& tri = mesh.triangles[entry.tri_id];
+    if (tri.vertices != entry.vertices){
+      stats.stale++;
+      continue;
+    }
+
+    const std::array<Vector, 3> p = mesh.get_vertices(tri);
+    const Shape shape = triangle_shape(p);
+    if (in_small_angle(tri.vertices[(shape.shortest + 1) % 3], tri.vertices[(shape.shortest + 2) % 3])){
+      stats.small_angles++;
+      continue;
+    }
+
+    Vector center = circumcenter_2d(p);
+    if (!std::isfinite(center[0]) || !std::isfinite(center[1])) continue;
+
+    // Behind an hull edge, the edge is split instead
+    locate_hint = entry.tri_id;
+    const auto [found_id, edge_id, orient] = find_nearest_triangle(center);
+    const MTriangle& found = mesh.triangles[found_id];
+    if (orient == TriOrient::CW){
+      const auto [u, w] = found.get_edge(edge_id);
+      encroached.push_back({ u, w, true });
+      bad.push(shape.quality, entry);
+      continue;
+    }
+
+    const std::array<Vector, 3> found_p = mesh.get_vertices(found);
+    if (found_p[0] == center || found_p[1] == center || found_p[2] == center) continue;
+
+    const std::array<double, 3> weights = barycentric_2d(found_p, center);
+    center[2] = weights[0] * found_p[0][2] + weights[1] * found_p[1][2] + weights[2] * found_p[2][2];
+    const size_t vertex = add_point(center);
+
+    // Segments of the link seeing the new vertex in their diametral circle
+    link.clear();
+    bool encroaches = false;
+    const size_t start = mesh.vertex_to_triangle[vertex];
+    size_t tri_id = start;
+    do {
+      const MTriangle& star_tri = mesh.triangles[tri_id];
+      const LocalId<3> id = star_tri.local_id_of(vertex);
+      link.push_back(star_tri.vertices[id + 1]);
+
+      if (!star_tri.is_infinite() && is_segment(star_tri, id) && apex_encroaches(star_tri, id)){
+        const auto [u, w] = star_tri.get_edge(id);
+        encroached.push_back({ u, w, true });
+        encroaches = true;
+      }
+      tri_id = star_tri.opposite_triangle[id + 1];
+    } while (tri_id != start);
+
+    if (encroaches && remove_point(vertex)){
+      // The hole is triangulated again in other slots, its bad triangles are queued again
+      stats.rejected++;
+      for (size_t v : link)
+        if (v != mesh.infinite_point) check_star(v);
+      continue;
+    }
+
+    on_segment.resize(mesh.vertices.size(), no_segment);
+    on_segment[vertex] = no_segment;
+    stats.circumcenters++;
+    check_star(vertex);
+  }
+
+  assert_triangle_mesh_valid(mesh);
+  return stats;
+}
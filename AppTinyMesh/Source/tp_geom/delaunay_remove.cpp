@@ -0,0 +1,211 @@
+#include <tp_geom/delaunay.h>
+#include <tp_geom/algo.h>
+#include <stack>
+
+// Vertex removal : the star of the vertex leaves a hole, bounded by the link of the vertex.
+// The Delaunay triangulation of the hole is built by clipping ears whose circumcircle holds no other
+// vertex of the hole, such an ear is a triangle of the new triangulation. On the hull the infinite
+// vertex is part of the hole, an infinite ear (inf, x, y) is valid when x -> y is a hull edge of the hole
+
+bool DelaunayTriangulation2D::is_ear(size_t id) const {
+  const size_t prev = hole_prev[id], next = hole_next[id];
+  const size_t a = hole[prev], b = hole[id], c = hole[next];
+  const size_t inf = mesh.infinite_point;
+
+  if (a != inf && b != inf && c != inf){
+    const std::array<Vector, 3> tri = { mesh.vertices[a], mesh.vertices[b], mesh.vertices[c] };
+    if (orientation_2d(tri) != TriOrient::CCW) return false;
+
+    for (size_t j = hole_next[next]; j != prev; j = hole_next[j])
+      if (hole[j] != inf && in_circle_2d(tri, mesh.vertices[hole[j]]) > 0) return false;
+
+    return true;
+  }
+
+  // The other vertices must be inside of the hull edge, or aligned with it but not on it
+  const auto [x, y] = a == inf ? std::pair(b, c) : b == inf ? std::pair(c, a) : std::pair(a, b);
+  const Vector& px = mesh.vertices[x];
+  const Vector& py = mesh.vertices[y];
+  const auto dot_2d = [](const Vector& u, const Vector& v){ return u[0] * v[0] + u[1] * v[1]; };
+
+  for (size_t j = hole_next[next]; j != prev; j = hole_next[j]){
+    const Vector& p = mesh.vertices[hole[j]];
+    const TriOrient orient = orientation_2d({ px, py, p });
+    if (orient == TriOrient::CCW) return false;
+
+    const bool between = dot_2d(p - px, py - px) > 0 && dot_2d(p - py, px - py) > 0;
+    if (orient == TriOrient::Flat && between) return false;
+  }
+
+  return true;
+}
+
+bool DelaunayTriangulation2D::remove_point(size_t vertex){
+  assert(vertex != mesh.infinite_point && vertex < mesh.vertices.size() && !mesh.is_free_vertex(vertex));
+
+  const size_t vertex_count = mesh.vertices.size() - TriangleMesh::v_start_offset - mesh.free_vertices.size();
+  if (vertex_count < 4) return false;
+
+  // Star of the vertex, CCW : triangle i is (vertex, hole[i], hole[i + 1])
+  hole.clear();
+  hole_tris.clear();
+  hole_outer.clear();
+  hole_constrained.clear();
+
+  const size_t start = mesh.vertex_to_triangle[vertex];
+  size_t tri_id = start;
+  do {
+    const MTriangle& tri = mesh.triangles[tri_id];
+    const LocalId<3> id = tri.local_id_of(vertex);
+    // The end of a constraint stays
+    if (tri.is_constrained(id + 1)) return false;
+
+    hole.push_back(tri.vertices[id + 1]);
+    hole_tris.push_back(tri_id);
+    hole_outer.push_back(tri.opposite_triangle[id]);
+    hole_constrained.push_back(tri.is_constrained(id));
+    tri_id = tri.opposite_triangle[id + 1];
+  } while (tri_id != start);
+
+  const size_t k = hole.size();
+  hole_next.resize(k);
+  hole_prev.resize(k);
+  for (size_t i = 0; i < k; i++){
+    hole_next[i] = (i + 1) % k;
+    hole_prev[i] = (i + k - 1) % k;
+  }
+
+  // Clips the ears until a triangle is left, the mesh isn't modified yet
+  ears.clear();
+  size_t id = 0;
+  for (size_t left = k; left >= 3; left--){
+    size_t tries = 0;
+    while (!is_ear(id)){
+      if (++tries == left) return false;
+      id = hole_next[id];
+    }
+
+    ears.push_back({ hole_prev[id], id, hole_next[id] });
+    hole_next[hole_prev[id]] = hole_next[id];
+    hole_prev[hole_next[id]] = hole_prev[id];
+
+    // Clipping an ear can only make its neighbours ears
+    id = hole_prev[id];
+  }
+
+  insert_stats.removes++;
+  sample_grid.erase(mesh, vertex);
+
+  const auto link = [&](size_t outer, size_t a, size_t b, size_t tri_id){
+    MTriangle& tri = mesh.triangles[outer];
+    tri.opposite_triangle[tri.find_edge(a, b)] = tri_id;
+  };
+
+  // Ear e takes the slot of the star triangle e, the two last slots are freed
+  for (size_t e = 0; e < ears.size(); e++){
+    const auto [prev, id, next] = ears[e];
+    const size_t a = hole[prev], b = hole[id], c = hole[next];
+    const size_t slot = hole_tris[e];
+
+    MTriangle& tri = mesh.triangles[slot];
+    tri.vertices = { a, b, c };
+    tri.opposite_triangle = { hole_outer[id], size_t_max, hole_outer[prev] };
+    tri.constraints = 0;
+    tri.set_constrained(0, hole_constrained[id]);
+    tri.set_constrained(2, hole_constrained[prev]);
+    link(hole_outer[id], b, c, slot);
+    link(hole_outer[prev], a, b, slot);
+
+    // (c, a) is an edge of the hole for the last ear, a diagonal taken by a next ear otherwise
+    if (e + 1 == ears.size()){
+      tri.opposite_triangle[1] = hole_outer[next];
+      tri.set_constrained(1, hole_constrained[next]);
+      link(hole_outer[next], c, a, slot);
+    }
+    hole_outer[prev] = slot;
+    hole_constrained[prev] = false;
+
+    mesh.vertex_to_triangle[a] = slot;
+    mesh.vertex_to_triangle[b] = slot;
+    mesh.vertex_to_triangle[c] = slot;
+  }
+
+  mesh.remove_triangle(hole_tris[k - 2]);
+  mesh.remove_triangle(hole_tris[k - 1]);
+  mesh.remove_point(vertex);
+  locate_hint = hole_tris[0];
+
+  assert_triangle_mesh_valid(mesh);
+  return true;
+}
+
+void DelaunayTriangulation2D::restore_delaunay_around(size_t vertex){
+  using EdgeRef = std::pair<size_t, LocalId<3>>;
+  std::stack<EdgeRef> to_check;
+
+  const size_t start = mesh.vertex_to_triangle[vertex];
+  size_t tri_id = start;
+  do {
+    const MTriangle& tri = mesh.triangles[tri_id];
+    for (int i = 0; i < 3; i++)
+      to_check.push({ tri_id, i });
+    tri_id = tri.opposite_triangle[tri.local_id_of(vertex) + 1];
+  } while (tri_id != start);
+
+  while (!to_check.empty()){
+    const auto [tri_id, edge_id] = to_check.top();
+    to_check.pop();
+
+    const MTriangle& tri = mesh.triangles[tri_id];
+    if (tri.is_infinite() || TriMeshAlgorithm::is_edge_delaunay_2d(mesh, tri_id, edge_id))
+      continue;
+
+    const size_t o_tri_id = tri.opposite_triangle[edge_id];
+    TriMeshAlgorithm::edge_flip(mesh, tri_id, edge_id);
+    insert_stats.flips++;
+
+    // Only the 4 outer edges of the quad can have become non Delaunay
+    for (int i = 0; i < 3; i++){
+      if (mesh.triangles[tri_id].opposite_triangle[i] != o_tri_id) to_check.push({ tri_id, i });
+      if (mesh.triangles[o_tri_id].opposite_triangle[i] != tri_id) to_check.push({ o_tri_id, i });
+    }
+  }
+}
+
+bool DelaunayTriangulation2D::move_point(size_t vertex, const Vector& point){
+  assert(vertex != mesh.infinite_point && vertex < mesh.vertices.size() && !mesh.is_free_vertex(vertex));
+
+  // The vertex stays inside of its star if all the triangles keep their orientation.
+  // On the hull the hull edges would have to be checked too, the vertex is inserted again instead
+  bool in_star = true;
+  const size_t start = mesh.vertex_to_triangle[vertex];
+  size_t tri_id = start;
+  do {
+    const MTriangle& tri = mesh.triangles[tri_id];
+    const LocalId<3> id = tri.local_id_of(vertex);
+    in_star = !tri.is_infinite()
+      && orientation_2d({ point, mesh.get_vertex(tri, id + 1), mesh.get_vertex(tri, id + 2) }) == TriOrient::CCW;
+    tri_id = tri.opposite_triangle[id + 1];
+  } while (in_star && tri_id != start);
+
+  if (in_star){
+    insert_stats.local_moves++;
+    sample_grid.erase(mesh, vertex);
+    mesh.vertices[vertex] = point;
+    sample_grid.insert(mesh, vertex);
+
+    restore_delaunay_around(vertex);
+    return true;
+  }
+
+  // Onto another vertex, the insertion would give the id of this one
+  const size_t duplicate = vertex_on(std::get<0>(find_nearest_triangle(point)), point);
+  if ((duplicate != size_t_max && duplicate != vertex) || !remove_point(vertex))
+    return false;
+
+  // The insertion takes the slot of the removed vertex back
+  mesh.reuse_next(vertex);
+  [[maybe_unused]] const size_t point_id = add_point(point);
+  assert(point_id == vertex);
+  return true;
+}
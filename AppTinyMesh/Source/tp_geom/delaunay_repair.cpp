@@ -0,0 +1,183 @@
+#include <tp_geom/delaunay.h>
+#include <tp_geom/algo.h>
+#include <atomic>
+
+// Parallel Lawson flips, by rounds :
+// - the queued edges are tested in parallel, the mesh isn't modified
+// - each non Delaunay edge claims the two triangles of its quad, the lowest priority wins each triangle.
+//   An edge holding both triangles, whose neighbour triangles aren't held by a lower priority,
+//   is independent of every other winner and is flipped. The others wait for the next round
+// - the outer edges of the flipped quads and the postponed edges make the next round
+// The priorities are a hash of the edge, they don't depend on the thread timings so the result
+// doesn't depend on the number of threads. Unlike the edge ids they aren't spatially correlated,
+// which keeps the chains of conflicting edges short
+
+namespace {
+  using EdgeRef = std::pair<size_t, LocalId<3>>;
+
+  struct Candidate {
+    EdgeRef edge;
+    size_t priority;
+    std::array<size_t, 6> tris; // Quad triangles first, then their neighbours
+  };
+
+  // Bijective mix of the edge (splitmix64 finalizer), two edges never have the same priority
+  size_t edge_priority(const EdgeRef& edge){
+    uint64_t x = 3 * uint64_t(edge.first) + int(edge.second);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+  }
+
+  // Side of the edge on its triangle of lowest id, size_t_max if the edge is on an infinite or a free triangle
+  EdgeRef canonical_edge(const TriangleMesh& mesh, size_t tri_id, LocalId<3> edge_id){
+    const MTriangle& tri = mesh.triangles[tri_id];
+    if (tri.is_free()) return { size_t_max, 0 };
+
+    const size_t o_tri_id = tri.opposite_triangle[edge_id];
+    const MTriangle& o_tri = mesh.triangles[o_tri_id];
+
+    if (tri.is_infinite() || o_tri.is_infinite())
+      return { size_t_max, 0 };
+
+    if (tri_id < o_tri_id) return { tri_id, edge_id };
+    return { o_tri_id, o_tri.find_edge(tri.get_edge(edge_id)) };
+  }
+
+  void claim(std::atomic<size_t>& owner, size_t priority){
+    size_t current = owner.load(std::memory_order_relaxed);
+    while (priority < current && !owner.compare_exchange_weak(current, priority, std::memory_order_relaxed));
+  }
+}
+
+namespace TriMeshAlgorithm {
+  FlipStats make_delaunay_parallel(TriangleMesh& mesh){
+    const size_t tri_count = mesh.triangles.size();
+    FlipStats stats;
+
+    // Bit i of queued[t] is set while edge i of triangle t is in the next round
+    std::vector<std::atomic<uint8_t>> queued(tri_count);
+    std::vector<std::atomic<size_t>> owner(tri_count);
+    for (auto& o : owner) o.store(size_t_max, std::memory_order_relaxed);
+
+    std::vector<EdgeRef> edges, next;
+    std::vector<Candidate> candidates;
+    std::vector<char> flipped;
+
+    // Each thread fills its own list, the lists are appended at the end of the loop
+    const auto push = [&](std::vector<EdgeRef>& local, size_t tri_id, LocalId<3> edge_id){
+      const EdgeRef edge = canonical_edge(mesh, tri_id, edge_id);
+      if (edge.first == size_t_max) return;
+
+      const uint8_t bit = 1 << edge.second;
+      if (!(queued[edge.first].fetch_or(bit, std::memory_order_relaxed) & bit))
+        local.push_back(edge);
+    };
+
+    const auto append = [&](std::vector<EdgeRef>& local){
+      #pragma omp critical
+      next.insert(next.end(), local.begin(), local.end());
+    };
+
+    #pragma omp parallel
+    {
+      std::vector<EdgeRef> local;
+      #pragma omp for schedule(dynamic, 1024) nowait
+      for (long t = 0; t < long(tri_count); t++)
+        for (int i = 0; i < 3; i++)
+          push(local, t, i);
+      append(local);
+    }
+
+    while (!next.empty()){
+      std::swap(edges, next);
+      next.clear();
+      stats.passes++;
+      stats.tests += edges.size();
+
+      // Tests, the non Delaunay edges become candidates
+      candidates.clear();
+      #pragma omp parallel
+      {
+        std::vector<Candidate> local;
+        #pragma omp for schedule(dynamic, 1024) nowait
+        for (long e = 0; e < long(edges.size()); e++){
+          const auto [tri_id, edge_id] = edges[e];
+          queued[tri_id].fetch_and(~(1 << edge_id), std::memory_order_relaxed);
+          if (is_edge_delaunay_2d(mesh, tri_id, edge_id)) continue;
+
+          const MTriangle& tri = mesh.triangles[tri_id];
+          const size_t o_tri_id = tri.opposite_triangle[edge_id];
+          const MTriangle& o_tri = mesh.triangles[o_tri_id];
+          const LocalId<3> o_edge_id = o_tri.find_edge(tri.get_edge(edge_id));
+
+          local.push_back({ edges[e], edge_priority(edges[e]), {
+            tri_id, o_tri_id,
+            tri.opposite_triangle[edge_id + 1], tri.opposite_triangle[edge_id + 2],
+            o_tri.opposite_triangle[o_edge_id + 1], o_tri.opposite_triangle[o_edge_id + 2]
+          }});
+        }
+
+        #pragma omp critical
+        candidates.insert(candidates.end(), local.begin(), local.end());
+      }
+
+      // Claims of the quads, then the flips of the winners.
+      // The neighbours of a winner aren't in the quad of another one, their links are updated safely
+      #pragma omp parallel for schedule(dynamic, 1024)
+      for (long c = 0; c < long(candidates.size()); c++){
+        claim(owner[candidates[c].tris[0]], candidates[c].priority);
+        claim(owner[candidates[c].tris[1]], candidates[c].priority);
+      }
+
+      flipped.assign(candidates.size(), false);
+      size_t flips = 0;
+
+      #pragma omp parallel for schedule(dynamic, 256) reduction(+: flips)
+      for (long c = 0; c < long(candidates.size()); c++){
+        const Candidate& candidate = candidates[c];
+        bool winner = owner[candidate.tris[0]].load(std::memory_order_relaxed) == candidate.priority
+                   && owner[candidate.tris[1]].load(std::memory_order_relaxed) == candidate.priority;
+        for (int i = 2; i < 6; i++)
+          winner = winner && owner[candidate.tris[i]].load(std::memory_order_relaxed) >= candidate.priority;
+
+        if (!winner) continue;
+
+        edge_flip_unchecked(mesh, candidate.edge.first, candidate.edge.second);
+        flipped[c] = true;
+        flips++;
+      }
+
+      stats.flips += flips;
+      stats.conflicts += candidates.size() - flips;
+
+      // Next round
+      #pragma omp parallel
+      {
+        std::vector<EdgeRef> local;
+        #pragma omp for schedule(dynamic, 256) nowait
+        for (long c = 0; c < long(candidates.size()); c++){
+          const Candidate& candidate = candidates[c];
+          const size_t tri_id = candidate.tris[0], o_tri_id = candidate.tris[1];
+          owner[tri_id].store(size_t_max, std::memory_order_relaxed);
+          owner[o_tri_id].store(size_t_max, std::memory_order_relaxed);
+
+          if (!flipped[c]){
+            push(local, tri_id, candidate.edge.second);
+            continue;
+          }
+
+          // Only the 4 outer edges of the quad can have become non Delaunay
+          for (int i = 0; i < 3; i++){
+            if (mesh.triangles[tri_id].opposite_triangle[i] != o_tri_id) push(local, tri_id, i);
+            if (mesh.triangles[o_tri_id].opposite_triangle[i] != tri_id) push(local, o_tri_id, i);
+          }
+        }
+        append(local);
+      }
+    }
+
+    assert_triangle_mesh_valid(mesh);
+    return stats;
+  }
+}
@@ -0,0 +1,136 @@
+#include <tp_geom/hull.h>
+#include <tp_geom/predicates.h>
+#include <algorithm>
+#include <array>
+#include <numeric>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// The octagon is made of the extreme points in 8 directions, its vertices are hull vertices so the points
+// strictly inside of it can't be. The directions are rounded, the octagon may then be slightly off,
+// but a point strictly on the left of each of its edges is still inside of the hull of its vertices
+
+namespace {
+  // Below this size a part isn't worth a thread
+  constexpr size_t min_part_size = 4096;
+
+  // CCW from the bottom
+  constexpr double directions[8][2] = { { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 } };
+
+  size_t thread_count(){
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+
+  bool same_xy(const Vector& a, const Vector& b){
+    return a[0] == b[0] && a[1] == b[1];
+  }
+
+  // Sorts the ids by x then y, drops the duplicates and returns the hull (Andrew's monotone chain)
+  std::vector<size_t> monotone_chain(const std::vector<Vector>& points, std::vector<size_t>& ids){
+    std::sort(ids.begin(), ids.end(), [&](size_t a, size_t b){
+      const Vector& p = points[a];
+      const Vector& q = points[b];
+      if (p[0] != q[0]) return p[0] < q[0];
+      if (p[1] != q[1]) return p[1] < q[1];
+      return a < b;
+    });
+    ids.erase(std::unique(ids.begin(), ids.end(), [&](size_t a, size_t b){ return same_xy(points[a], points[b]); }), ids.end());
+    if (ids.size() < 3) return ids;
+
+    std::vector<size_t> hull(2 * ids.size());
+    size_t k = 0;
+    const auto turns_left = [&](size_t id){ return Predicates::orient_2d(points[hull[k - 2]], points[hull[k - 1]], points[id]) > 0; };
+
+    // Lower chain from left to right, then upper chain back
+    for (size_t id : ids){
+      while (k >= 2 && !turns_left(id)) k--;
+      hull[k++] = id;
+    }
+
+    const size_t lower = k + 1;
+    for (size_t i = ids.size() - 1; i-- > 0;){
+      while (k >= lower && !turns_left(ids[i])) k--;
+      hull[k++] = ids[i];
+    }
+
+    // The last one is the first one again
+    hull.resize(k - 1);
+    return hull;
+  }
+}
+
+namespace ConvexHull {
+  std::vector<size_t> convex_hull_2d(const std::vector<Vector>& points, HullStats* stats){
+    if (points.empty()) return {};
+
+    const size_t parts = std::clamp<size_t>(points.size() / min_part_size, 1, thread_count());
+    const auto part_begin = [&](size_t p){ return points.size() * p / parts; };
+    const auto further = [&](int d, size_t a, size_t b){
+      return directions[d][0] * points[a][0] + directions[d][1] * points[a][1] > directions[d][0] * points[b][0] + directions[d][1] * points[b][1];
+    };
+
+    std::vector<std::array<size_t, 8>> part_extremes(parts);
+
+    #pragma omp parallel for schedule(static)
+    for (long p = 0; p < long(parts); p++){
+      std::array<size_t, 8>& extremes = part_extremes[p];
+      extremes.fill(part_begin(p));
+
+      for (size_t i = part_begin(p) + 1; i < part_begin(p + 1); i++)
+        for (int d = 0; d < 8; d++)
+          if (further(d, i, extremes[d])) extremes[d] = i;
+    }
+
+    std::array<size_t, 8> extremes = part_extremes[0];
+    for (size_t p = 1; p < parts; p++)
+      for (int d = 0; d < 8; d++)
+        if (further(d, part_extremes[p][d], extremes[d])) extremes[d] = part_extremes[p][d];
+
+    // A repeated vertex would make an empty edge, nothing would be strictly inside
+    std::vector<Vector> octagon;
+    for (size_t i : extremes)
+      if (octagon.empty() || !same_xy(octagon.back(), points[i])) octagon.push_back(points[i]);
+    while (octagon.size() > 1 && same_xy(octagon.front(), octagon.back())) octagon.pop_back();
+
+    const auto inside_octagon = [&](const Vector& point){
+      if (octagon.size() < 3) return false;
+      for (size_t i = 0; i < octagon.size(); i++)
+        if (Predicates::orient_2d(octagon[i], octagon[(i + 1) % octagon.size()], point) <= 0) return false;
+      return true;
+    };
+
+    std::vector<std::vector<size_t>> partial(parts);
+    std::vector<size_t> kept(parts, 0);
+
+    #pragma omp parallel for schedule(static)
+    for (long p = 0; p < long(parts); p++){
+      std::vector<size_t> ids;
+      for (size_t i = part_begin(p); i < part_begin(p + 1); i++)
+        if (!inside_octagon(points[i])) ids.push_back(i);
+
+      kept[p] = ids.size();
+      partial[p] = monotone_chain(points, ids);
+    }
+
+    std::vector<size_t> candidates;
+    for (const std::vector<size_t>& hull : partial)
+      candidates.insert(candidates.end(), hull.begin(), hull.end());
+
+    if (stats){
+      stats->kept = std::accumulate(kept.begin(), kept.end(), size_t(0));
+      stats->partial = candidates.size();
+    }
+
+    return monotone_chain(points, candidates);
+  }
+
+  size_t hull_edge_count(const std::vector<Vector>& points){
+    const size_t vertices = convex_hull_2d(points).size();
+    return vertices >= 3 ? vertices : 0;
+  }
+}
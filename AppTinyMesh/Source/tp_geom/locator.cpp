@@ -0,0 +1,148 @@
+#include <tp_geom/locator.h>
+#include <algorithm>
+#include <cmath>
+
+void VertexSampleGrid::insert(const TriangleMesh& mesh, size_t vertex){
+  seen++;
+  if (samples.size() * samples.size() >= seen) return;
+
+  samples.push_back(vertex);
+  if (samples.size() >= rebuild_at){
+    rebuild(mesh);
+    return;
+  }
+
+  const Vector& p = mesh.vertices[vertex];
+  cells[cell_coord(p[1], min_y) * side + cell_coord(p[0], min_x)].push_back(vertex);
+}
+
+void VertexSampleGrid::erase(const TriangleMesh& mesh, size_t vertex){
+  if (seen > 0) seen--;
+  if (samples.empty()) return;
+
+  // The cell holds about two samples, the sample list is only searched for sampled vertices
+  const Vector& p = mesh.vertices[vertex];
+  std::vector<size_t>& cell = cells[cell_coord(p[1], min_y) * side + cell_coord(p[0], min_x)];
+  const auto it = std::find(cell.begin(), cell.end(), vertex);
+  if (it == cell.end()) return;
+
+  *it = cell.back();
+  cell.pop_back();
+
+  const auto sample = std::find(samples.begin(), samples.end(), vertex);
+  *sample = samples.back();
+  samples.pop_back();
+}
+
+// The grid bounds follow the sample, it is rebuilt each time the sample doubles
+void VertexSampleGrid::rebuild(const TriangleMesh& mesh){
+  const Vector& first = mesh.vertices[samples[0]];
+  min_x = first[0];
+  min_y = first[1];
+  double max_x = min_x, max_y = min_y;
+
+  for (size_t v : samples){
+    const Vector& p = mesh.vertices[v];
+    min_x = std::min(min_x, p[0]);
+    min_y = std::min(min_y, p[1]);
+    max_x = std::max(max_x, p[0]);
+    max_y = std::max(max_y, p[1]);
+  }
+
+  // About two samples per cell
+  side = std::max<size_t>(1, size_t(std::ceil(std::sqrt(samples.size() / 2.))));
+  const double extent = std::max(max_x - min_x, max_y - min_y);
+  cell_size = extent > 0 ? extent / side : 1;
+
+  cells.assign(side * side, {});
+  for (size_t v : samples){
+    const Vector& p = mesh.vertices[v];
+    cells[cell_coord(p[1], min_y) * side + cell_coord(p[0], min_x)].push_back(v);
+  }
+
+  rebuild_at = std::max<size_t>(16, 2 * samples.size());
+}
+
+size_t VertexSampleGrid::cell_coord(double v, double min) const {
+  const double c = std::floor((v - min) / cell_size);
+  if (!(c > 0)) return 0;
+  return std::min(side - 1, size_t(c));
+}
+
+size_t VertexSampleGrid::nearest(const TriangleMesh& mesh, const Vector& point, double start_d2) const {
+  if (samples.empty() || start_d2 <= cell_size * cell_size) return size_t_max;
+
+  const long cx = cell_coord(point[0], min_x);
+  const long cy = cell_coord(point[1], min_y);
+  const long last = side - 1;
+
+  size_t best = size_t_max;
+  double best_d2 = start_d2;
+  long found_ring = -1;
+
+  const auto visit = [&](long x, long y){
+    if (x < 0 || y < 0 || x > last || y > last) return;
+    for (size_t v : cells[y * side + x]){
+      const Vector& p = mesh.vertices[v];
+      const double dx = p[0] - point[0], dy = p[1] - point[1];
+      const double d2 = dx * dx + dy * dy;
+      if (d2 < best_d2){
+        best_d2 = d2;
+        best = v;
+      }
+    }
+  };
+
+  // Search rings of cells around the query, one more ring after the first hit
+  for (long r = 0; r <= long(side); r++){
+    if (r == 0)
+      visit(cx, cy);
+
+    for (long i = -r; i <= r && r > 0; i++){
+      visit(cx + i, cy - r);
+      visit(cx + i, cy + r);
+      if (i != -r && i != r){
+        visit(cx - r, cy + i);
+        visit(cx + r, cy + i);
+      }
+    }
+
+    // Farther rings can't hold anything closer than the current best
+    const double ring_dist = r * cell_size;
+    if (best_d2 <= ring_dist * ring_dist) break;
+
+    if (best == size_t_max) continue;
+    if (found_ring < 0) found_ring = r;
+    if (r > found_ring) break;
+  }
+
+  return best;
+}
+
+void VertexSampleGrid::assign(const TriangleMesh& mesh){
+  clear();
+  seen = mesh.vertices.size() - TriangleMesh::v_start_offset;
+
+  // Every sqrt(n)-th vertex, as insert would keep
+  const size_t step = std::max<size_t>(1, size_t(std::sqrt(double(seen))));
+  for (size_t v = TriangleMesh::v_start_offset; v < mesh.vertices.size(); v += step)
+    if (!mesh.is_free_vertex(v)) samples.push_back(v);
+
+  if (!samples.empty())
+    rebuild(mesh);
+}
+
+// The vertices keep their place, only their ids change
+void VertexSampleGrid::remap(const std::vector<size_t>& new_ids){
+  for (size_t& v : samples) v = new_ids[v];
+  for (std::vector<size_t>& cell : cells)
+    for (size_t& v : cell) v = new_ids[v];
+}
+
+void VertexSampleGrid::clear(){
+  samples.clear();
+  cells.clear();
+  seen = 0;
+  rebuild_at = 0;
+  side = 0;
+}
@@ -1,20 +1,41 @@
 #include "tp_geom/utils.h"
 #include <tp_geom/mesh.h>
+#include <tp_geom/spatial_sort.h>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+  size_t thread_count(){
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+}
 
-bool MTriangle::is_infinite() const {
-  return local_id_of(TriangleMesh::infinite_point) >= 0;
+template <typename Index>
+bool BasicMTriangle<Index>::is_infinite() const {
+  return local_id_of(BasicTriangleMesh<Index>::infinite_point) >= 0;
 }
 
+template <typename Index>
 std::pair<size_t, size_t>
-MTriangle::get_edge(LocalId<3> a) const {
+BasicMTriangle<Index>::get_edge(LocalId<3> a) const {
   return {vertices[a + 1], vertices[a + 2]};
 }
 
-LocalId<3> MTriangle::find_edge(std::pair<size_t, size_t> p) const {
+template <typename Index>
+LocalId<3> BasicMTriangle<Index>::find_edge(std::pair<size_t, size_t> p) const {
   return find_edge(p.first, p.second);
 }
 
-LocalId<3> MTriangle::find_edge(size_t a, size_t b) const {
+template <typename Index>
+LocalId<3> BasicMTriangle<Index>::find_edge(size_t a, size_t b) const {
   LocalId<3> ret = LocalId<3>::make_invalid();
   assert(a != b);
   bool a_exist = false;
@@ -34,7 +55,8 @@ LocalId<3> MTriangle::find_edge(size_t a, size_t b) const {
   return ret;
 }
 
-LocalId<3> MTriangle::local_id_of(size_t v) const {
+template <typename Index>
+LocalId<3> BasicMTriangle<Index>::local_id_of(size_t v) const {
   char l_id = LocalId<3>::make_invalid();
   for (int i = 0; i < 3; i++) {
     if (vertices[i] == v)
@@ -46,7 +68,8 @@ LocalId<3> MTriangle::local_id_of(size_t v) const {
 
 // Assumes that the vertex V has a fully circular neighboring of triangle 
 // Otherwise good luck with that
-FaceAroundVIt TriangleMesh::faces_around_v(size_t vertex){
+template <typename Index>
+typename BasicTriangleMesh<Index>::FaceAroundVIt BasicTriangleMesh<Index>::faces_around_v(size_t vertex){
   const size_t face = vertex_to_triangle[vertex];
   assert(face < triangles.size());
   return FaceAroundVIt(this, face, vertex);
@@ -80,7 +103,8 @@ FaceAroundVIt TriangleMesh::faces_around_v(size_t vertex){
 //   return faces;
 // }
 
-TriangleMesh::TriangleMesh(){
+template <typename Index>
+BasicTriangleMesh<Index>::BasicTriangleMesh(){
   vertices.resize(1); 
   vertex_to_triangle.resize(1);
   vertex_to_triangle[0] = size_t_max;
@@ -88,20 +112,227 @@ TriangleMesh::TriangleMesh(){
   vertices[0] = Vector{0,0,inf};
 }
 
-size_t TriangleMesh::add_point(const Vector& point){
+template <typename Index>
+size_t BasicTriangleMesh<Index>::add_point(const Vector& point){
+  if (!free_vertices.empty()){
+    const size_t ret = free_vertices.back();
+    free_vertices.pop_back();
+    vertices[ret] = point;
+    return ret;
+  }
+
+  check_size(vertices.size() + 1, 0);
   size_t ret = vertices.size();
   vertices.emplace_back(point);
   vertex_to_triangle.emplace_back(); 
   return ret;
 }
 
-void TriangleMesh::clear(){
+template <typename Index>
+size_t BasicTriangleMesh<Index>::add_triangle(){
+  if (!free_triangles.empty()){
+    const size_t ret = free_triangles.back();
+    free_triangles.pop_back();
+    return ret;
+  }
+
+  check_size(0, triangles.size() + 1);
+  triangles.emplace_back();
+  return triangles.size() - 1;
+}
+
+template <typename Index>
+void BasicTriangleMesh<Index>::check_size(size_t vertex_count, size_t triangle_count){
+  if (vertex_count > max_vertices || triangle_count > max_triangles)
+    throw std::length_error("BasicTriangleMesh : more vertices or triangles than its ids can hold, see TP_GEOM_INDEX_64");
+}
+
+template <typename Index>
+void BasicTriangleMesh<Index>::remove_point(size_t vertex){
+  assert(vertex != infinite_point && !is_free_vertex(vertex));
+  vertex_to_triangle[vertex] = size_t_max;
+  free_vertices.push_back(vertex);
+}
+
+// The vertex was freed lately most of the time, the search starts from the end
+template <typename Index>
+void BasicTriangleMesh<Index>::reuse_next(size_t vertex){
+  const auto it = std::find(free_vertices.rbegin(), free_vertices.rend(), vertex);
+  assert(it != free_vertices.rend());
+  std::iter_swap(it, free_vertices.rbegin());
+}
+
+template <typename Index>
+void BasicTriangleMesh<Index>::remove_triangle(size_t tri_id){
+  assert(!triangles[tri_id].is_free());
+  triangles[tri_id] = MTriangle();
+  free_triangles.push_back(tri_id);
+}
+
+template <typename Index>
+void BasicTriangleMesh<Index>::clear(){
   vertices.resize(1);
-  vertex_to_triangle.clear();
+  vertex_to_triangle.assign(1, size_t_max);
   triangles.clear();
+  free_vertices.clear();
+  free_triangles.clear();
+}
+
+// New id of each element of [0, n) : first the live ones in the order given by the keys of their points,
+// from first_id, then the free ones in their order
+template <typename IsLive, typename Point>
+static std::vector<size_t> hilbert_renumbering(size_t n, size_t first_id, const IsLive& is_live, const Point& point){
+  std::vector<size_t> live;
+  live.reserve(n);
+  for (size_t i = first_id; i < n; i++)
+    if (is_live(i)) live.push_back(i);
+
+  std::vector<Vector> points(live.size());
+  #pragma omp parallel for schedule(static)
+  for (long i = 0; i < long(live.size()); i++)
+    points[i] = point(live[i]);
+
+  const std::vector<size_t> order = SpatialSort::hilbert_order(points);
+
+  std::vector<size_t> new_ids(n, size_t_max);
+  for (size_t i = 0; i < first_id; i++)
+    new_ids[i] = i;
+
+  #pragma omp parallel for schedule(static)
+  for (long i = 0; i < long(order.size()); i++)
+    new_ids[live[order[i]]] = first_id + i;
+
+  size_t next_id = first_id + live.size();
+  for (size_t i = first_id; i < n; i++)
+    if (new_ids[i] == size_t_max) new_ids[i] = next_id++;
+
+  return new_ids;
 }
 
-std::array<Vector, 3> TriangleMesh::get_vertices(const MTriangle &tri) const{
+template <typename Index>
+MeshRemap BasicTriangleMesh<Index>::reorder(Ordering ordering){
+  assert(ordering == Ordering::Hilbert);
+  MeshRemap remap;
+
+  remap.vertices = hilbert_renumbering(vertices.size(), v_start_offset,
+    [&](size_t v){ return !is_free_vertex(v); },
+    [&](size_t v){ return vertices[v]; });
+
+  // A triangle is placed at its centroid, an infinite one at the middle of its hull edge
+  remap.triangles = hilbert_renumbering(triangles.size(), 0,
+    [&](size_t t){ return !triangles[t].is_free(); },
+    [&](size_t t){
+      const MTriangle& tri = triangles[t];
+      Vector sum(0, 0, 0);
+      int count = 0;
+      for (int i = 0; i < 3; i++){
+        if (tri.vertices[i] == infinite_point) continue;
+        sum += vertices[tri.vertices[i]];
+        count++;
+      }
+      return sum / count;
+    });
+
+  apply(remap, vertices.size(), triangles.size());
+  for (size_t& v : free_vertices) v = remap.vertices[v];
+  for (size_t& t : free_triangles) t = remap.triangles[t];
+  return remap;
+}
+
+// New id of each element of [0, n) once the free ones are dropped, in the same order. Each thread counts
+// the live elements of its block, the sum of the counts before a block is where it starts
+template <typename IsLive>
+static std::vector<size_t> compact_renumbering(size_t n, size_t first_id, const IsLive& is_live, size_t& count){
+  // Below this size a block isn't worth a thread
+  constexpr size_t min_block_size = 1 << 16;
+
+  std::vector<size_t> new_ids(n, size_t_max);
+  for (size_t i = 0; i < first_id && i < n; i++)
+    new_ids[i] = i;
+
+  const size_t live_range = n > first_id ? n - first_id : 0;
+  const size_t blocks = std::max<size_t>(1, std::min(thread_count(), live_range / min_block_size));
+  const auto block_begin = [&](size_t b){ return first_id + live_range * b / blocks; };
+  std::vector<size_t> offsets(blocks + 1, 0);
+
+  #pragma omp parallel for schedule(static, 1)
+  for (long b = 0; b < long(blocks); b++){
+    size_t live = 0;
+    for (size_t i = block_begin(b); i < block_begin(b + 1); i++)
+      live += is_live(i);
+    offsets[b + 1] = live;
+  }
+
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  #pragma omp parallel for schedule(static, 1)
+  for (long b = 0; b < long(blocks); b++){
+    size_t id = first_id + offsets[b];
+    for (size_t i = block_begin(b); i < block_begin(b + 1); i++)
+      if (is_live(i)) new_ids[i] = id++;
+  }
+
+  count = std::min(first_id, n) + offsets[blocks];
+  return new_ids;
+}
+
+template <typename Index>
+MeshRemap BasicTriangleMesh<Index>::compact(){
+  MeshRemap remap;
+  size_t vertex_count, triangle_count;
+
+  remap.vertices = compact_renumbering(vertices.size(), v_start_offset, [&](size_t v){ return !is_free_vertex(v); }, vertex_count);
+  remap.triangles = compact_renumbering(triangles.size(), 0, [&](size_t t){ return !triangles[t].is_free(); }, triangle_count);
+
+  apply(remap, vertex_count, triangle_count);
+  free_vertices = {};
+  free_triangles = {};
+  return remap;
+}
+
+// The new arrays are filled in parallel, each element is written by the one that moves to it
+template <typename Index>
+void BasicTriangleMesh<Index>::apply(const MeshRemap& remap, size_t vertex_count, size_t triangle_count){
+  const auto new_triangle_id = [&](size_t t){ return t == size_t_max ? size_t_max : remap.triangles[t]; };
+
+  std::vector<Vector> new_vertices(vertex_count);
+  std::vector<StoredIndex<Index>> new_vertex_to_triangle(vertex_count, size_t_max);
+
+  #pragma omp parallel for schedule(static)
+  for (long v = 0; v < long(vertices.size()); v++){
+    const size_t new_v = remap.vertices[v];
+    if (new_v == size_t_max) continue;
+    new_vertices[new_v] = vertices[v];
+    new_vertex_to_triangle[new_v] = new_triangle_id(vertex_to_triangle[v]);
+  }
+
+  std::vector<MTriangle> new_triangles(triangle_count);
+
+  #pragma omp parallel for schedule(static)
+  for (long t = 0; t < long(triangles.size()); t++){
+    const size_t new_t = remap.triangles[t];
+    if (new_t == size_t_max) continue;
+
+    const MTriangle& tri = triangles[t];
+    MTriangle& new_tri = new_triangles[new_t];
+    new_tri.constraints = tri.constraints;
+    if (tri.is_free()) continue;
+
+    // The local ids don't change, the links keep the edges they know
+    for (int i = 0; i < 3; i++){
+      new_tri.vertices[i] = remap.vertices[tri.vertices[i]];
+      const auto& o = tri.opposite_triangle[i];
+      new_tri.opposite_triangle[i] = { new_triangle_id(o), o.edge() };
+    }
+  }
+
+  vertices.swap(new_vertices);
+  vertex_to_triangle.swap(new_vertex_to_triangle);
+  triangles.swap(new_triangles);
+}
+
+template <typename Index>
+std::array<Vector, 3> BasicTriangleMesh<Index>::get_vertices(const MTriangle &tri) const{
   std::array<Vector, 3> ret; 
   ret[0] = get_vertex(tri, 0);
   ret[1] = get_vertex(tri, 1);
@@ -110,7 +341,8 @@ std::array<Vector, 3> TriangleMesh::get_vertices(const MTriangle &tri) const{
 }
 
 // Only works on vertices that have a fully closed neighboring of triangles
-double TriangleMesh::laplacian(size_t vertex, const LaplacianFunc &compute) {
+template <typename Index>
+double BasicTriangleMesh<Index>::laplacian(size_t vertex, const LaplacianFunc &compute) {
   float this_value = compute(*this, vertex);
   float sum_r = 0, sum_area = 0;
 
@@ -165,7 +397,8 @@ double TriangleMesh::laplacian(size_t vertex, const LaplacianFunc &compute) {
   return sum_r / (2 * (1. / 3) * sum_area);
 }
 
-inline size_t FaceAroundVIt::next_tri(const bool sign) const {
+template <typename Index>
+size_t BasicFaceAroundVIt<Index>::next_tri(const bool sign) const {
   MTriangle& tri = mesh->triangles[triangle];
   LocalId<3> id = tri.local_id_of(vertex);
   assert(id >= 0);
@@ -174,16 +407,19 @@ inline size_t FaceAroundVIt::next_tri(const bool sign) const {
   return tri.opposite_triangle[next_id];
 }
 
-bool FaceAroundVIt::operator==(const FaceAroundVIt& other) const {
+template <typename Index>
+bool BasicFaceAroundVIt<Index>::operator==(const FaceAroundVIt& other) const {
   return other.mesh == mesh && other.triangle == triangle && other.vertex == vertex;
 }
 
 
-bool FaceAroundVIt::operator!=(const FaceAroundVIt& other) const {
+template <typename Index>
+bool BasicFaceAroundVIt<Index>::operator!=(const FaceAroundVIt& other) const {
   return !(other == *this);
 }
 
-FaceAroundVIt FaceAroundVIt::operator-(const int count) const{
+template <typename Index>
+BasicFaceAroundVIt<Index> BasicFaceAroundVIt<Index>::operator-(const int count) const{
   if (count == 0) return *this;
 
   size_t tri = triangle;
@@ -193,7 +429,8 @@ FaceAroundVIt FaceAroundVIt::operator-(const int count) const{
   return FaceAroundVIt(mesh, tri, vertex);
 }
 
-FaceAroundVIt FaceAroundVIt::operator+(const int count) const{
+template <typename Index>
+BasicFaceAroundVIt<Index> BasicFaceAroundVIt<Index>::operator+(const int count) const{
   if (count == 0) return *this;
 
   size_t tri = triangle;
@@ -203,25 +440,35 @@ FaceAroundVIt FaceAroundVIt::operator+(const int count) const{
   return FaceAroundVIt(mesh, tri, vertex);
 }
 
-FaceAroundVIt& FaceAroundVIt::operator--(const int) {
+template <typename Index>
+BasicFaceAroundVIt<Index>& BasicFaceAroundVIt<Index>::operator--(const int) {
   triangle = next_tri(0);
   return *this;
 }
 
 
-FaceAroundVIt& FaceAroundVIt::operator++(const int) {
+template <typename Index>
+BasicFaceAroundVIt<Index>& BasicFaceAroundVIt<Index>::operator++(const int) {
   triangle = next_tri(1);
   return *this;
 }
 
+// Both storages are compiled, whichever MeshIndex picks
+template struct BasicMTriangle<uint32_t>;
+template struct BasicMTriangle<size_t>;
+template struct BasicTriangleMesh<uint32_t>;
+template struct BasicTriangleMesh<size_t>;
+template struct BasicFaceAroundVIt<uint32_t>;
+template struct BasicFaceAroundVIt<size_t>;
+
 void assert_triangles_valid(const TriangleMesh& m, const bool orient_test, const bool connectivity_test){
 #ifndef NDEBUG
-  for (size_t tri_id = 0; tri_id < m.triangles.size(); tri_id++){
-    const auto v = [&](const MTriangle& tri, size_t id) { 
-      return m.vertices[tri.vertices[id]];
-    };
+  // x and y of the corners of the finite triangles, oriented in one batch at the end
+  std::vector<double> coords[6];
 
+  for (size_t tri_id = 0; tri_id < m.triangles.size(); tri_id++){
     const MTriangle& tri = m.triangles[tri_id];
+    if (tri.is_free()) continue;
 
     for (int i = 0; i < 3; i++){
       assert(tri.vertices[i] < m.vertices.size());
@@ -233,23 +480,49 @@ void assert_triangles_valid(const TriangleMesh& m, const bool orient_test, const
         const auto other_eid = otri.find_edge(edge);
         assert(other_eid != -1);
         assert(otri.opposite_triangle[other_eid] == tri_id);
+        assert(tri.opposite_triangle[i].edge() == Adjacency<MeshIndex>::unknown_edge || tri.opposite_triangle[i].edge() == other_eid);
+        assert(otri.is_constrained(other_eid) == tri.is_constrained(i));
       }
     }
 
-    if (tri.is_infinite()){
-      return;
-    }
+    if (tri.is_infinite())
+      continue;
 
-    if (orient_test)
-      assert(orientation_2d({v(tri, 0), v(tri, 1), v(tri, 2)}) >= TriOrient::Flat);
+    if (orient_test){
+      for (int k = 0; k < 3; k++){
+        coords[2 * k].push_back(m.vertices[tri.vertices[k]][0]);
+        coords[2 * k + 1].push_back(m.vertices[tri.vertices[k]][1]);
+      }
+    }
   }
+
+  const size_t n = coords[0].size();
+  std::vector<signed char> sign(n);
+  Predicates::orient_2d_batch(n, { coords[0].data(), coords[1].data() },
+    { coords[2].data(), coords[3].data() }, { coords[4].data(), coords[5].data() }, sign.data());
+
+  for (size_t i = 0; i < n; i++)
+    assert(sign[i] >= 0);
 #endif
 }
 
 void assert_vertices_valid(const TriangleMesh &m){
 #ifndef NDEBUG
+  size_t free_count = 0;
+
   for (size_t vertex_id = 0; vertex_id < m.vertices.size(); vertex_id++){
     size_t tri_id = m.vertex_to_triangle[vertex_id];
+
+    // Don't fail if the infinite point is not used 
+    if (vertex_id == TriangleMesh::infinite_point && tri_id == size_t_max)
+      continue;
+
+    // Removed vertices have no triangle, there must be as many as in the free list
+    if (m.is_free_vertex(vertex_id)){
+      free_count++;
+      continue;
+    }
+
     assert(tri_id < m.triangles.size());
     const MTriangle& tri = m.triangles[tri_id];
 
@@ -261,12 +534,10 @@ void assert_vertices_valid(const TriangleMesh &m){
       assert(tri.vertices[id + 2] != v);
     }
 
-    // Don't fail if the infinite point is not used 
-    if (vertex_id == TriangleMesh::infinite_point && tri_id == size_t_max)
-      return;
-    
     assert(tri.local_id_of(vertex_id) >= 0);
   }
+
+  assert(free_count == m.free_vertices.size());
 #endif
 }
 
@@ -0,0 +1,183 @@
+#include <tp_geom/predicates.h>
+#include <array>
+
+// Exact computations with floating point expansions : a number is the sum of doubles
+// sorted by increasing magnitude that don't overlap, the last one gives the sign.
+// The zero components are dropped, so the expansions stay much shorter than their capacity
+
+namespace {
+  template <int N>
+  struct Expansion {
+    std::array<double, N> c;
+    int size = 0;
+
+    void push(double v){ if (v != 0) c[size++] = v; }
+    double approximation() const { return size > 0 ? c[size - 1] : 0; }
+  };
+
+  // x + y == a + b exactly
+  void two_sum(double a, double b, double& x, double& y){
+    x = a + b;
+    const double b_virtual = x - a;
+    const double a_virtual = x - b_virtual;
+    y = (a - a_virtual) + (b - b_virtual);
+  }
+
+  // x + y == a * b exactly
+  void two_product(double a, double b, double& x, double& y){
+    x = a * b;
+    y = std::fma(a, b, -x);
+  }
+
+  Expansion<2> difference(double a, double b){
+    double x, y;
+    two_sum(a, -b, x, y);
+    Expansion<2> e;
+    e.push(y);
+    e.push(x);
+    return e;
+  }
+
+  // Adds b to h in place, h must have room for one more component
+  template <int N>
+  void grow(Expansion<N>& h, double b){
+    double q = b;
+    int size = 0;
+
+    for (int i = 0; i < h.size; i++){
+      double error;
+      two_sum(q, h.c[i], q, error);
+      if (error != 0) h.c[size++] = error;
+    }
+
+    if (q != 0) h.c[size++] = q;
+    h.size = size;
+  }
+
+  template <int N, int M>
+  Expansion<N + M> sum(const Expansion<N>& e, const Expansion<M>& f){
+    Expansion<N + M> h;
+    for (int i = 0; i < e.size; i++) h.c[i] = e.c[i];
+    h.size = e.size;
+
+    for (int i = 0; i < f.size; i++)
+      grow(h, f.c[i]);
+    return h;
+  }
+
+  template <int N>
+  Expansion<2 * N> scale(const Expansion<N>& e, double b){
+    Expansion<2 * N> h;
+    if (e.size == 0 || b == 0) return h;
+
+    double q, error;
+    two_product(e.c[0], b, q, error);
+    h.push(error);
+
+    for (int i = 1; i < e.size; i++){
+      double product, product_error, partial;
+      two_product(e.c[i], b, product, product_error);
+      two_sum(q, product_error, partial, error);
+      h.push(error);
+      two_sum(product, partial, q, error);
+      h.push(error);
+    }
+
+    h.push(q);
+    return h;
+  }
+
+  template <int N, int M>
+  Expansion<2 * N * M> product(const Expansion<N>& e, const Expansion<M>& f){
+    Expansion<2 * N * M> h;
+    for (int i = 0; i < f.size; i++){
+      const Expansion<2 * N> scaled = scale(e, f.c[i]);
+      for (int j = 0; j < scaled.size; j++)
+        grow(h, scaled.c[j]);
+    }
+    return h;
+  }
+
+  template <int N>
+  Expansion<N> negate(Expansion<N> e){
+    for (int i = 0; i < e.size; i++)
+      e.c[i] = -e.c[i];
+    return e;
+  }
+
+  Expansion<2> exact_product(double a, double b){
+    double x, y;
+    two_product(a, b, x, y);
+    Expansion<2> e;
+    e.push(y);
+    e.push(x);
+    return e;
+  }
+
+  // The 3d tests are computed on the coordinates themselves rather than on differences, the expansions
+  // stay shorter (Shewchuk's exact versions do the same). Determinant of the rows p, q, r
+  Expansion<24> det_3(const Vector& p, const Vector& q, const Vector& r){
+    const auto yz = sum(exact_product(q[1], r[2]), negate(exact_product(r[1], q[2])));
+    const auto xz = sum(exact_product(q[0], r[2]), negate(exact_product(r[0], q[2])));
+    const auto xy = sum(exact_product(q[0], r[1]), negate(exact_product(r[0], q[1])));
+
+    return sum(sum(scale(yz, p[0]), negate(scale(xz, p[1]))), scale(xy, p[2]));
+  }
+
+  Expansion<6> lift(const Vector& p){
+    return sum(sum(exact_product(p[0], p[0]), exact_product(p[1], p[1])), exact_product(p[2], p[2]));
+  }
+}
+
+namespace Predicates {
+  double orient_2d_exact(const Vector& a, const Vector& b, const Vector& c){
+    const auto acx = difference(a[0], c[0]), acy = difference(a[1], c[1]);
+    const auto bcx = difference(b[0], c[0]), bcy = difference(b[1], c[1]);
+
+    return sum(product(acx, bcy), negate(product(acy, bcx))).approximation();
+  }
+
+  double in_circle_exact(const Vector& a, const Vector& b, const Vector& c, const Vector& d){
+    const auto adx = difference(a[0], d[0]), ady = difference(a[1], d[1]);
+    const auto bdx = difference(b[0], d[0]), bdy = difference(b[1], d[1]);
+    const auto cdx = difference(c[0], d[0]), cdy = difference(c[1], d[1]);
+
+    const auto a_lift = sum(product(adx, adx), product(ady, ady));
+    const auto b_lift = sum(product(bdx, bdx), product(bdy, bdy));
+    const auto c_lift = sum(product(cdx, cdx), product(cdy, cdy));
+
+    const auto bc = sum(product(bdx, cdy), negate(product(cdx, bdy)));
+    const auto ca = sum(product(cdx, ady), negate(product(adx, cdy)));
+    const auto ab = sum(product(adx, bdy), negate(product(bdx, ady)));
+
+    return sum(sum(product(a_lift, bc), product(b_lift, ca)), product(c_lift, ab)).approximation();
+  }
+
+  // det(b - a, c - a, d - a) = det(b, c, d) - det(a, c, d) + det(a, b, d) - det(a, b, c)
+  double orient_3d_exact(const Vector& a, const Vector& b, const Vector& c, const Vector& d){
+    return sum(sum(det_3(b, c, d), negate(det_3(a, c, d))), sum(det_3(a, b, d), negate(det_3(a, b, c)))).approximation();
+  }
+
+  // Minus the determinant of the rows (x, y, z, x² + y² + z², 1) of a, b, c, d, e, expanded along the last two columns
+  double in_sphere_exact(const Vector& a, const Vector& b, const Vector& c, const Vector& d, const Vector& e){
+    const auto la = lift(a), lb = lift(b), lc = lift(c), ld = lift(d), le = lift(e);
+
+    const auto abc = det_3(a, b, c), abd = det_3(a, b, d), abe = det_3(a, b, e), acd = det_3(a, c, d), ace = det_3(a, c, e);
+    const auto ade = det_3(a, d, e), bcd = det_3(b, c, d), bce = det_3(b, c, e), bde = det_3(b, d, e), cde = det_3(c, d, e);
+
+    // Determinant of the rows (x, y, z, lift) of p, q, r, s from the minors without each row
+    const auto det_4 = [](const Expansion<6>& lp, const Expansion<6>& lq, const Expansion<6>& lr, const Expansion<6>& ls,
+                          const Expansion<24>& qrs, const Expansion<24>& prs, const Expansion<24>& pqs, const Expansion<24>& pqr){
+      return sum(sum(product(lq, prs), negate(product(lp, qrs))), sum(product(ls, pqr), negate(product(lr, pqs))));
+    };
+
+    const auto without_a = det_4(lb, lc, ld, le, cde, bde, bce, bcd);
+    const auto without_b = det_4(la, lc, ld, le, cde, ade, ace, acd);
+    const auto without_c = det_4(la, lb, ld, le, bde, ade, abe, abd);
+    const auto without_d = det_4(la, lb, lc, le, bce, ace, abe, abc);
+    const auto without_e = det_4(la, lb, lc, ld, bcd, acd, abd, abc);
+
+    const auto det = sum(sum(sum(without_a, negate(without_b)), sum(without_c, negate(without_d))), without_e);
+    return -det.approximation();
+  }
+}
@@ -0,0 +1,231 @@
+#include <tp_geom/predicates.h>
+
+// The error bounds of the filters assume every product is rounded,
+// a fused multiply-add would change the rounding of the determinants
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TP_GEOM_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using Predicates::SoaPoints;
+
+namespace {
+  constexpr double orient_bound = (3 + 16 * Predicates::epsilon) * Predicates::epsilon;
+  constexpr double in_circle_bound = (10 + 96 * Predicates::epsilon) * Predicates::epsilon;
+
+  // The kernels handle the first tests by packs and return how many they did, the rest is done one by one
+  using OrientKernel = size_t (*)(size_t, SoaPoints, SoaPoints, SoaPoints, signed char*);
+  using InCircleKernel = size_t (*)(size_t, SoaPoints, SoaPoints, SoaPoints, SoaPoints, signed char*);
+
+  signed char sign_of(double v){
+    return (v > 0) - (v < 0);
+  }
+
+  Vector at(SoaPoints p, size_t i){
+    return Vector(p.x[i], p.y[i], 0);
+  }
+
+  size_t orient_scalar(size_t, SoaPoints, SoaPoints, SoaPoints, signed char*){ return 0; }
+  size_t in_circle_scalar(size_t, SoaPoints, SoaPoints, SoaPoints, SoaPoints, signed char*){ return 0; }
+
+  // Lanes the filter couldn't decide
+  signed char orient_exact(size_t i, SoaPoints a, SoaPoints b, SoaPoints c){
+    Predicates::stats.orient_exact++;
+    return sign_of(Predicates::orient_2d_exact(at(a, i), at(b, i), at(c, i)));
+  }
+
+  signed char in_circle_exact(size_t i, SoaPoints a, SoaPoints b, SoaPoints c, SoaPoints d){
+    Predicates::stats.in_circle_exact++;
+    return sign_of(Predicates::in_circle_exact(at(a, i), at(b, i), at(c, i), at(d, i)));
+  }
+
+#ifdef TP_GEOM_X86_SIMD
+  __attribute__((target("avx2")))
+  inline __m256d abs_avx2(__m256d v){
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+  }
+
+  // Same filters as Predicates::orient_2d and Predicates::in_circle, on 4 lanes
+  __attribute__((target("avx2")))
+  size_t orient_avx2(size_t n, SoaPoints a, SoaPoints b, SoaPoints c, signed char* sign){
+    const __m256d bound = _mm256_set1_pd(orient_bound);
+    const __m256d zero = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+      const __m256d cx = _mm256_loadu_pd(c.x + i), cy = _mm256_loadu_pd(c.y + i);
+      const __m256d left = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(a.x + i), cx), _mm256_sub_pd(_mm256_loadu_pd(b.y + i), cy));
+      const __m256d right = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(a.y + i), cy), _mm256_sub_pd(_mm256_loadu_pd(b.x + i), cx));
+      const __m256d det = _mm256_sub_pd(left, right);
+
+      const __m256d err = _mm256_mul_pd(bound, _mm256_add_pd(abs_avx2(left), abs_avx2(right)));
+      const int decided = _mm256_movemask_pd(_mm256_cmp_pd(abs_avx2(det), err, _CMP_GE_OQ));
+      const int positive = _mm256_movemask_pd(_mm256_cmp_pd(det, zero, _CMP_GT_OQ));
+      const int negative = _mm256_movemask_pd(_mm256_cmp_pd(det, zero, _CMP_LT_OQ));
+
+      for (int l = 0; l < 4; l++)
+        sign[i + l] = decided >> l & 1 ? (positive >> l & 1) - (negative >> l & 1) : orient_exact(i + l, a, b, c);
+    }
+
+    return i;
+  }
+
+  __attribute__((target("avx2")))
+  size_t in_circle_avx2(size_t n, SoaPoints a, SoaPoints b, SoaPoints c, SoaPoints d, signed char* sign){
+    const __m256d bound = _mm256_set1_pd(in_circle_bound);
+    const __m256d zero = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+      const __m256d dx = _mm256_loadu_pd(d.x + i), dy = _mm256_loadu_pd(d.y + i);
+      const __m256d adx = _mm256_sub_pd(_mm256_loadu_pd(a.x + i), dx), ady = _mm256_sub_pd(_mm256_loadu_pd(a.y + i), dy);
+      const __m256d bdx = _mm256_sub_pd(_mm256_loadu_pd(b.x + i), dx), bdy = _mm256_sub_pd(_mm256_loadu_pd(b.y + i), dy);
+      const __m256d cdx = _mm256_sub_pd(_mm256_loadu_pd(c.x + i), dx), cdy = _mm256_sub_pd(_mm256_loadu_pd(c.y + i), dy);
+
+      const __m256d bdxcdy = _mm256_mul_pd(bdx, cdy), cdxbdy = _mm256_mul_pd(cdx, bdy);
+      const __m256d cdxady = _mm256_mul_pd(cdx, ady), adxcdy = _mm256_mul_pd(adx, cdy);
+      const __m256d adxbdy = _mm256_mul_pd(adx, bdy), bdxady = _mm256_mul_pd(bdx, ady);
+
+      const __m256d a_lift = _mm256_add_pd(_mm256_mul_pd(adx, adx), _mm256_mul_pd(ady, ady));
+      const __m256d b_lift = _mm256_add_pd(_mm256_mul_pd(bdx, bdx), _mm256_mul_pd(bdy, bdy));
+      const __m256d c_lift = _mm256_add_pd(_mm256_mul_pd(cdx, cdx), _mm256_mul_pd(cdy, cdy));
+
+      const __m256d det = _mm256_add_pd(_mm256_add_pd(
+        _mm256_mul_pd(a_lift, _mm256_sub_pd(bdxcdy, cdxbdy)),
+        _mm256_mul_pd(b_lift, _mm256_sub_pd(cdxady, adxcdy))),
+        _mm256_mul_pd(c_lift, _mm256_sub_pd(adxbdy, bdxady)));
+
+      const __m256d permanent = _mm256_add_pd(_mm256_add_pd(
+        _mm256_mul_pd(_mm256_add_pd(abs_avx2(bdxcdy), abs_avx2(cdxbdy)), a_lift),
+        _mm256_mul_pd(_mm256_add_pd(abs_avx2(cdxady), abs_avx2(adxcdy)), b_lift)),
+        _mm256_mul_pd(_mm256_add_pd(abs_avx2(adxbdy), abs_avx2(bdxady)), c_lift));
+
+      const __m256d err = _mm256_mul_pd(bound, permanent);
+      const int decided = _mm256_movemask_pd(_mm256_cmp_pd(abs_avx2(det), err, _CMP_GT_OQ));
+      const int positive = _mm256_movemask_pd(_mm256_cmp_pd(det, zero, _CMP_GT_OQ));
+
+      for (int l = 0; l < 4; l++)
+        sign[i + l] = decided >> l & 1 ? (positive >> l & 1 ? 1 : -1) : in_circle_exact(i + l, a, b, c, d);
+    }
+
+    return i;
+  }
+
+  // Same on 8 lanes
+  __attribute__((target("avx512f")))
+  size_t orient_avx512(size_t n, SoaPoints a, SoaPoints b, SoaPoints c, signed char* sign){
+    const __m512d bound = _mm512_set1_pd(orient_bound);
+    const __m512d zero = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8){
+      const __m512d cx = _mm512_loadu_pd(c.x + i), cy = _mm512_loadu_pd(c.y + i);
+      const __m512d left = _mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(a.x + i), cx), _mm512_sub_pd(_mm512_loadu_pd(b.y + i), cy));
+      const __m512d right = _mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(a.y + i), cy), _mm512_sub_pd(_mm512_loadu_pd(b.x + i), cx));
+      const __m512d det = _mm512_sub_pd(left, right);
+
+      const __m512d err = _mm512_mul_pd(bound, _mm512_add_pd(_mm512_abs_pd(left), _mm512_abs_pd(right)));
+      const __mmask8 decided = _mm512_cmp_pd_mask(_mm512_abs_pd(det), err, _CMP_GE_OQ);
+      const __mmask8 positive = _mm512_cmp_pd_mask(det, zero, _CMP_GT_OQ);
+      const __mmask8 negative = _mm512_cmp_pd_mask(det, zero, _CMP_LT_OQ);
+
+      for (int l = 0; l < 8; l++)
+        sign[i + l] = decided >> l & 1 ? (positive >> l & 1) - (negative >> l & 1) : orient_exact(i + l, a, b, c);
+    }
+
+    return i;
+  }
+
+  __attribute__((target("avx512f")))
+  size_t in_circle_avx512(size_t n, SoaPoints a, SoaPoints b, SoaPoints c, SoaPoints d, signed char* sign){
+    const __m512d bound = _mm512_set1_pd(in_circle_bound);
+    const __m512d zero = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8){
+      const __m512d dx = _mm512_loadu_pd(d.x + i), dy = _mm512_loadu_pd(d.y + i);
+      const __m512d adx = _mm512_sub_pd(_mm512_loadu_pd(a.x + i), dx), ady = _mm512_sub_pd(_mm512_loadu_pd(a.y + i), dy);
+      const __m512d bdx = _mm512_sub_pd(_mm512_loadu_pd(b.x + i), dx), bdy = _mm512_sub_pd(_mm512_loadu_pd(b.y + i), dy);
+      const __m512d cdx = _mm512_sub_pd(_mm512_loadu_pd(c.x + i), dx), cdy = _mm512_sub_pd(_mm512_loadu_pd(c.y + i), dy);
+
+      const __m512d bdxcdy = _mm512_mul_pd(bdx, cdy), cdxbdy = _mm512_mul_pd(cdx, bdy);
+      const __m512d cdxady = _mm512_mul_pd(cdx, ady), adxcdy = _mm512_mul_pd(adx, cdy);
+      const __m512d adxbdy = _mm512_mul_pd(adx, bdy), bdxady = _mm512_mul_pd(bdx, ady);
+
+      const __m512d a_lift = _mm512_add_pd(_mm512_mul_pd(adx, adx), _mm512_mul_pd(ady, ady));
+      const __m512d b_lift = _mm512_add_pd(_mm512_mul_pd(bdx, bdx), _mm512_mul_pd(bdy, bdy));
+      const __m512d c_lift = _mm512_add_pd(_mm512_mul_pd(cdx, cdx), _mm512_mul_pd(cdy, cdy));
+
+      const __m512d det = _mm512_add_pd(_mm512_add_pd(
+        _mm512_mul_pd(a_lift, _mm512_sub_pd(bdxcdy, cdxbdy)),
+        _mm512_mul_pd(b_lift, _mm512_sub_pd(cdxady, adxcdy))),
+        _mm512_mul_pd(c_lift, _mm512_sub_pd(adxbdy, bdxady)));
+
+      const __m512d permanent = _mm512_add_pd(_mm512_add_pd(
+        _mm512_mul_pd(_mm512_add_pd(_mm512_abs_pd(bdxcdy), _mm512_abs_pd(cdxbdy)), a_lift),
+        _mm512_mul_pd(_mm512_add_pd(_mm512_abs_pd(cdxady), _mm512_abs_pd(adxcdy)), b_lift)),
+        _mm512_mul_pd(_mm512_add_pd(_mm512_abs_pd(adxbdy), _mm512_abs_pd(bdxady)), c_lift));
+
+      const __m512d err = _mm512_mul_pd(bound, permanent);
+      const __mmask8 decided = _mm512_cmp_pd_mask(_mm512_abs_pd(det), err, _CMP_GT_OQ);
+      const __mmask8 positive = _mm512_cmp_pd_mask(det, zero, _CMP_GT_OQ);
+
+      for (int l = 0; l < 8; l++)
+        sign[i + l] = decided >> l & 1 ? (positive >> l & 1 ? 1 : -1) : in_circle_exact(i + l, a, b, c, d);
+    }
+
+    return i;
+  }
+#endif
+
+  struct BatchKernels {
+    OrientKernel orient = orient_scalar;
+    InCircleKernel in_circle = in_circle_scalar;
+    const char* isa = "scalar";
+  };
+
+  // Picked once, from what the running cpu supports
+  const BatchKernels& batch_kernels(){
+    static const BatchKernels kernels = [](){
+      BatchKernels k;
+#ifdef TP_GEOM_X86_SIMD
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f"))
+        k = { orient_avx512, in_circle_avx512, "avx512" };
+      else if (__builtin_cpu_supports("avx2"))
+        k = { orient_avx2, in_circle_avx2, "avx2" };
+#endif
+      return k;
+    }();
+
+    return kernels;
+  }
+}
+
+namespace Predicates {
+  void orient_2d_batch(size_t n, SoaPoints a, SoaPoints b, SoaPoints c, signed char* sign){
+    const size_t done = batch_kernels().orient(n, a, b, c, sign);
+    stats.orient_calls += done;
+
+    for (size_t i = done; i < n; i++)
+      sign[i] = sign_of(orient_2d(at(a, i), at(b, i), at(c, i)));
+  }
+
+  void in_circle_batch(size_t n, SoaPoints a, SoaPoints b, SoaPoints c, SoaPoints d, signed char* sign){
+    const size_t done = batch_kernels().in_circle(n, a, b, c, d, sign);
+    stats.in_circle_calls += done;
+
+    for (size_t i = done; i < n; i++)
+      sign[i] = sign_of(in_circle(at(a, i), at(b, i), at(c, i), at(d, i)));
+  }
+
+  const char* batch_isa(){
+    return batch_kernels().isa;
+  }
+}
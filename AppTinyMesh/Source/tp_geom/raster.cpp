@@ -0,0 +1,249 @@
+#include <tp_geom/raster.h>
+#include <tp_geom/voronoi.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// The grid is cut in tiles of tile_size x tile_size pixels. The triangles are binned by the tiles their pixels
+// cover (compressed rows, as the Voronoi cells), then each tile scan converts its triangles : the rows whose
+// center is in [v_min, v_max) of the triangle, and on each row the columns in [u_left, u_right).
+// Both triangles of an edge compute its x the same way, from its lowest end, so each pixel center is taken
+// by a single triangle and none falls between two.
+// Sibson : the triangles whose circumcircle holds the pixel make a cavity (Bowyer-Watson). The pixel would take
+// to each vertex v of the cavity boundary the part of its Voronoi cell between the new Voronoi edges (the
+// circumcenters of (p, prev, v) and of (p, v, next)) and the old circumcenters of the cavity triangles around v
+
+namespace {
+  constexpr size_t tile_size = 256;
+
+  // Pixel coordinates : pixel centers are on integers, v goes down
+  struct PixelFrame {
+    double x_min, y_max, dx, dy;
+
+    double u(double x) const { return (x - x_min) / dx - 0.5; }
+    double v(double y) const { return (y_max - y) / dy - 0.5; }
+  };
+
+  // Pixels holding the triangle, [col_begin, col_end) x [row_begin, row_end) clamped to the grid
+  struct PixelRect {
+    long col_begin, col_end, row_begin, row_end;
+  };
+
+  PixelRect pixel_rect(const PixelFrame& frame, const std::array<Vector, 3>& p, size_t width, size_t height){
+    double u_min = frame.u(p[0][0]), u_max = u_min, v_min = frame.v(p[0][1]), v_max = v_min;
+    for (int i = 1; i < 3; i++){
+      u_min = std::min(u_min, frame.u(p[i][0]));
+      u_max = std::max(u_max, frame.u(p[i][0]));
+      v_min = std::min(v_min, frame.v(p[i][1]));
+      v_max = std::max(v_max, frame.v(p[i][1]));
+    }
+
+    const auto clamp = [](double c, size_t size){ return long(std::clamp(std::ceil(c), 0., double(size))); };
+    return { clamp(u_min, width), clamp(u_max, width), clamp(v_min, height), clamp(v_max, height) };
+  }
+
+  struct CavityEdge {
+    size_t a, b, tri;
+  };
+
+  // Buffers of a thread
+  struct SibsonWorkspace {
+    std::vector<size_t> cavity;
+    std::vector<CavityEdge> boundary;
+    std::vector<CavityEdge> ring; // Boundary edges in CCW order
+    std::vector<double> px, py;
+  };
+
+  // Natural neighbour value at p, tri_id holds p. NaN if the cavity is broken or reaches the hull
+  double sibson(const TriangleMesh& mesh, const std::vector<double>& cx, const std::vector<double>& cy,
+                const Vector& p, size_t tri_id, SibsonWorkspace& ws){
+    for (size_t v : mesh.triangles[tri_id].vertices)
+      if (mesh.vertices[v][0] == p[0] && mesh.vertices[v][1] == p[1]) return mesh.vertices[v][2];
+
+    ws.cavity.assign(1, tri_id);
+    ws.boundary.clear();
+
+    for (size_t i = 0; i < ws.cavity.size(); i++){
+      const MTriangle& tri = mesh.triangles[ws.cavity[i]];
+
+      for (int e = 0; e < 3; e++){
+        const size_t o_tri_id = tri.opposite_triangle[e];
+        const MTriangle& o_tri = mesh.triangles[o_tri_id];
+        if (o_tri.is_infinite()) return std::numeric_limits<double>::quiet_NaN();
+        if (std::find(ws.cavity.begin(), ws.cavity.end(), o_tri_id) != ws.cavity.end()) continue;
+
+        if (!tri.is_constrained(e) && in_circle_2d(mesh.get_vertices(o_tri), p) > 0)
+          ws.cavity.push_back(o_tri_id);
+        else {
+          const auto [a, b] = tri.get_edge(e);
+          ws.boundary.push_back({ a, b, ws.cavity[i] });
+        }
+      }
+    }
+
+    if (ws.boundary.size() != ws.cavity.size() + 2) return std::numeric_limits<double>::quiet_NaN();
+
+    // Each edge (a, b) has the cavity on its left, the next one starts at b
+    ws.ring.assign(1, ws.boundary[0]);
+    while (ws.ring.size() < ws.boundary.size()){
+      const auto next = std::find_if(ws.boundary.begin(), ws.boundary.end(), [&](const CavityEdge& e){ return e.a == ws.ring.back().b; });
+      if (next == ws.boundary.end()) return std::numeric_limits<double>::quiet_NaN();
+      ws.ring.push_back(*next);
+    }
+
+    const size_t k = ws.ring.size();
+    double total = 0, value = 0;
+
+    for (size_t i = 0; i < k; i++){
+      const CavityEdge& in = ws.ring[i];
+      const CavityEdge& out = ws.ring[i + 1 == k ? 0 : i + 1];
+      const size_t v = in.b;
+
+      // New Voronoi vertex of the in edge, the old ones turning CW around v, new Voronoi vertex of the out edge
+      const Vector g_in = circumcenter_2d({ p, mesh.vertices[in.a], mesh.vertices[v] });
+      const Vector g_out = circumcenter_2d({ p, mesh.vertices[v], mesh.vertices[out.b] });
+      ws.px.assign(1, g_in[0]);
+      ws.py.assign(1, g_in[1]);
+
+      size_t t = in.tri;
+      for (size_t steps = 0; ; steps++){
+        if (steps > ws.cavity.size()) return std::numeric_limits<double>::quiet_NaN();
+        ws.px.push_back(cx[t]);
+        ws.py.push_back(cy[t]);
+        if (t == out.tri) break;
+
+        const MTriangle& tri = mesh.triangles[t];
+        t = tri.opposite_triangle[tri.local_id_of(v) + 2];
+      }
+
+      ws.px.push_back(g_out[0]);
+      ws.py.push_back(g_out[1]);
+
+      double area = 0;
+      for (size_t j = 0; j < ws.px.size(); j++){
+        const size_t l = j + 1 == ws.px.size() ? 0 : j + 1;
+        area += ws.px[j] * ws.py[l] - ws.px[l] * ws.py[j];
+      }
+
+      area = std::abs(area) / 2;
+      total += area;
+      value += area * mesh.vertices[v][2];
+    }
+
+    if (!(total > 0) || !std::isfinite(value)) return std::numeric_limits<double>::quiet_NaN();
+    return value / total;
+  }
+}
+
+Vector Raster::pixel_center(size_t col, size_t row) const {
+  const double dx = (bounds[1][0] - bounds[0][0]) / width;
+  const double dy = (bounds[1][1] - bounds[0][1]) / height;
+  return Vector(bounds[0][0] + (col + 0.5) * dx, bounds[1][1] - (row + 0.5) * dy, 0);
+}
+
+void Raster::write(std::ostream& stream) const {
+  stream.write(reinterpret_cast<const char*>(values.data()), std::streamsize(values.size() * sizeof(float)));
+}
+
+namespace TriMeshAlgorithm {
+  Raster rasterize(const TriangleMesh& mesh, const Box& bounds, size_t width, size_t height, Raster::Interpolation mode){
+    Raster raster;
+    raster.width = width;
+    raster.height = height;
+    raster.bounds = bounds;
+    raster.values.assign(width * height, std::numeric_limits<float>::quiet_NaN());
+    if (width == 0 || height == 0) return raster;
+
+    const PixelFrame frame = { bounds[0][0], bounds[1][1], (bounds[1][0] - bounds[0][0]) / width, (bounds[1][1] - bounds[0][1]) / height };
+    const size_t tiles_x = (width + tile_size - 1) / tile_size;
+    const size_t tiles_y = (height + tile_size - 1) / tile_size;
+
+    // Triangles of each tile, counted then written
+    std::vector<size_t> tile_offsets(tiles_x * tiles_y + 1, 0);
+    std::vector<size_t> tile_tris;
+
+    const auto bin = [&](const auto& visit){
+      for (size_t t = 0; t < mesh.triangles.size(); t++){
+        const MTriangle& tri = mesh.triangles[t];
+        if (tri.is_free() || tri.is_infinite()) continue;
+
+        const PixelRect rect = pixel_rect(frame, mesh.get_vertices(tri), width, height);
+        if (rect.col_begin >= rect.col_end || rect.row_begin >= rect.row_end) continue;
+
+        for (size_t ty = rect.row_begin / tile_size; ty <= (rect.row_end - 1) / tile_size; ty++)
+          for (size_t tx = rect.col_begin / tile_size; tx <= (rect.col_end - 1) / tile_size; tx++)
+            visit(ty * tiles_x + tx, t);
+      }
+    };
+
+    bin([&](size_t tile, size_t){ tile_offsets[tile + 1]++; });
+    for (size_t i = 0; i + 1 < tile_offsets.size(); i++)
+      tile_offsets[i + 1] += tile_offsets[i];
+
+    tile_tris.resize(tile_offsets.back());
+    std::vector<size_t> fill(tile_offsets.begin(), tile_offsets.end() - 1);
+    bin([&](size_t tile, size_t t){ tile_tris[fill[tile]++] = t; });
+
+    std::vector<double> cx, cy;
+    if (mode == Raster::Interpolation::Sibson)
+      circumcenters(mesh, cx, cy);
+
+    #pragma omp parallel
+    {
+      SibsonWorkspace ws;
+
+      #pragma omp for schedule(dynamic, 1)
+      for (long tile = 0; tile < long(tiles_x * tiles_y); tile++){
+        const long col_begin = (tile % tiles_x) * tile_size, row_begin = (tile / tiles_x) * tile_size;
+        const long col_end = std::min<long>(width, col_begin + tile_size), row_end = std::min<long>(height, row_begin + tile_size);
+
+        for (size_t i = tile_offsets[tile]; i < tile_offsets[tile + 1]; i++){
+          const size_t t = tile_tris[i];
+          const std::array<Vector, 3> p = mesh.get_vertices(mesh.triangles[t]);
+
+          // Corners in pixel coordinates, sorted by v
+          std::array<Vector, 3> q;
+          for (int k = 0; k < 3; k++)
+            q[k] = Vector(frame.u(p[k][0]), frame.v(p[k][1]), p[k][2]);
+          std::sort(q.begin(), q.end(), [](const Vector& a, const Vector& b){ return a[1] < b[1]; });
+
+          // z = z0 + a (u - u0) + b (v - v0), from the normal of the plane
+          const Vector n = (q[1] - q[0]) / (q[2] - q[0]);
+          if (n[2] == 0) continue;
+          const double a = -n[0] / n[2], b = -n[1] / n[2];
+
+          const auto edge_u = [](const Vector& low, const Vector& high, double v){
+            return low[0] + (v - low[1]) * (high[0] - low[0]) / (high[1] - low[1]);
+          };
+
+          const long r_begin = std::max<long>(row_begin, long(std::ceil(q[0][1])));
+          const long r_end = std::min<long>(row_end, long(std::ceil(q[2][1])));
+
+          for (long r = r_begin; r < r_end; r++){
+            const double u_long = edge_u(q[0], q[2], r);
+            const double u_short = r < q[1][1] ? edge_u(q[0], q[1], r) : edge_u(q[1], q[2], r);
+
+            const long c_begin = std::max<long>(col_begin, long(std::ceil(std::min(u_long, u_short))));
+            const long c_end = std::min<long>(col_end, long(std::ceil(std::max(u_long, u_short))));
+            if (c_begin >= c_end) continue;
+
+            float* row = raster.values.data() + r * width;
+            const double row_z = q[0][2] + b * (r - q[0][1]) - a * q[0][0];
+
+            for (long c = c_begin; c < c_end; c++)
+              row[c] = float(row_z + a * c);
+
+            if (mode != Raster::Interpolation::Sibson) continue;
+
+            for (long c = c_begin; c < c_end; c++){
+              const double z = sibson(mesh, cx, cy, raster.pixel_center(c, r), t, ws);
+              if (!std::isnan(z)) row[c] = float(z);
+            }
+          }
+        }
+      }
+    }
+
+    return raster;
+  }
+}
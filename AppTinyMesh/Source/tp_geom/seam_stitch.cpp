@@ -0,0 +1,155 @@
+#include <tp_geom/seam_stitch.h>
+#include <cmath>
+#include <stack>
+
+namespace {
+  // Open edge of a kept triangle, it is also an edge of the seam triangulation
+  struct SeamEdge {
+    size_t tri;
+    char edge;
+    size_t inner = size_t_max;    // Seam triangle on the side of the kept one
+    char inner_edge = 0;
+    size_t seam_tri = size_t_max; // Seam triangle on the other side
+    char seam_edge = 0;
+  };
+}
+
+namespace SeamStitch {
+  bool circumcircle(const std::array<Vector, 3>& tri, Circle& circle){
+    const double bx = tri[1][0] - tri[0][0], by = tri[1][1] - tri[0][1];
+    const double cx = tri[2][0] - tri[0][0], cy = tri[2][1] - tri[0][1];
+    const double d = 2 * (bx * cy - by * cx);
+    if (!(d > 0)) return false;
+
+    const double b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+    const double ux = (cy * b2 - by * c2) / d;
+    const double uy = (bx * c2 - cx * b2) / d;
+
+    circle.r = std::sqrt(ux * ux + uy * uy) * (1 + 1e-6);
+    circle.x = tri[0][0] + ux;
+    circle.y = tri[0][1] + uy;
+    return true;
+  }
+
+  bool fill_holes(TriangleMesh& out, TriangleMesh& seam, const std::vector<size_t>& seam_to_global,
+                  const std::vector<size_t>& global_to_seam){
+    const size_t kept_count = out.triangles.size();
+
+    std::vector<SeamEdge> edges;
+    for (size_t t = 0; t < kept_count; t++)
+      for (char e = 0; e < 3; e++)
+        if (out.triangles[t].opposite_triangle[e] == size_t_max)
+          edges.push_back({ t, e });
+
+    // Finds them in the seam triangulation
+    bool found = true;
+    #pragma omp parallel for reduction(&&: found)
+    for (long i = 0; i < long(edges.size()); i++){
+      SeamEdge& edge = edges[i];
+      const auto [a, b] = out.triangles[edge.tri].get_edge(edge.edge);
+      const size_t sa = global_to_seam[a];
+      const size_t sb = global_to_seam[b];
+      if (sa == size_t_max || sb == size_t_max){
+        found = false;
+        continue;
+      }
+
+      // (a, b) has the same orientation in the inner triangle as in the kept one
+      const auto face_begin = seam.faces_around_v(sa);
+      auto face_it = face_begin;
+      do {
+        const LocalId<3> id = face_it->local_id_of(sa);
+        if (face_it->vertices[id + 1] == sb){
+          edge.inner = face_it.get_tri_id();
+          edge.inner_edge = id + 2;
+          break;
+        }
+        face_it++;
+      } while (face_it != face_begin);
+
+      if (edge.inner == size_t_max){
+        found = false;
+        continue;
+      }
+
+      edge.seam_tri = seam.triangles[edge.inner].opposite_triangle[edge.inner_edge];
+      edge.seam_edge = seam.triangles[edge.seam_tri].find_edge(sa, sb);
+    }
+
+    if (!found) return false;
+
+    // The seam triangles covering the kept areas are dropped
+    std::vector<char> boundary(seam.triangles.size(), 0); // Bit e set when edge e is a kept area boundary
+    std::vector<char> removed(seam.triangles.size(), 0);
+    std::stack<size_t> to_remove;
+
+    for (const SeamEdge& edge : edges){
+      boundary[edge.inner] |= 1 << edge.inner_edge;
+      boundary[edge.seam_tri] |= 1 << edge.seam_edge;
+
+      if (!removed[edge.inner]){
+        removed[edge.inner] = 1;
+        to_remove.push(edge.inner);
+      }
+    }
+
+    while (!to_remove.empty()){
+      const size_t t = to_remove.top();
+      to_remove.pop();
+
+      for (int e = 0; e < 3; e++){
+        const size_t o = seam.triangles[t].opposite_triangle[e];
+        if (boundary[t] & (1 << e) || removed[o]) continue;
+        // Leaked out of a kept area
+        if (seam.triangles[o].is_infinite()) return false;
+        removed[o] = 1;
+        to_remove.push(o);
+      }
+    }
+
+    for (const SeamEdge& edge : edges)
+      if (removed[edge.seam_tri]) return false;
+
+    // The seam triangles follow the kept ones
+    size_t tri_count = kept_count;
+    std::vector<size_t> seam_global(seam.triangles.size(), size_t_max);
+    for (size_t t = 0; t < seam.triangles.size(); t++)
+      if (!removed[t]) seam_global[t] = tri_count++;
+
+    TriangleMesh::check_size(out.vertices.size(), tri_count);
+    out.triangles.resize(tri_count);
+
+    #pragma omp parallel for
+    for (long t = 0; t < long(seam.triangles.size()); t++){
+      if (removed[t]) continue;
+      const MTriangle& local = seam.triangles[t];
+      MTriangle& tri = out.triangles[seam_global[t]];
+
+      for (int i = 0; i < 3; i++){
+        tri.vertices[i] = seam_to_global[local.vertices[i]];
+        tri.opposite_triangle[i] = seam_global[local.opposite_triangle[i]];
+      }
+    }
+
+    for (const SeamEdge& edge : edges){
+      const size_t from_seam = seam_global[edge.seam_tri];
+      out.triangles[edge.tri].opposite_triangle[edge.edge] = from_seam;
+      out.triangles[from_seam].opposite_triangle[edge.seam_edge] = edge.tri;
+    }
+
+    out.vertex_to_triangle.assign(out.vertices.size(), size_t_max);
+
+    bool linked = true;
+    #pragma omp parallel for reduction(&&: linked)
+    for (long t = 0; t < long(out.triangles.size()); t++){
+      const MTriangle& tri = out.triangles[t];
+      for (int i = 0; i < 3; i++){
+        linked = linked && tri.opposite_triangle[i] != size_t_max;
+        #pragma omp atomic write
+        raw_id(out.vertex_to_triangle[tri.vertices[i]]) = t;
+      }
+    }
+
+    return linked;
+  }
+}
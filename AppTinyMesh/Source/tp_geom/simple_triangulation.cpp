@@ -14,8 +14,7 @@ void SimpleTriangulation::add_vertex(const Vector& point) {
 }
 
 void SimpleTriangulation::add_triangle(const std::array<size_t, 3> &vertices) {
-  MTriangle tri;
-  tri.vertices = vertices;
+  MTriangle tri(vertices);
 
   size_t tri_id = mesh.triangles.size();
 
@@ -0,0 +1,235 @@
+#include <tp_geom/spatial_sort.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace SpatialSort {
+  static constexpr uint32_t hilbert_side = 1u << 16;
+
+  // Spreads the 16 low bits of x on the even bits
+  static uint32_t interleave_bits(uint32_t x){
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+  }
+
+  // Branchless version of the usual quadrant rotation loop : the rotations of all 
+  // the levels are computed with a parallel prefix scan on the bits of x and y
+  uint32_t hilbert_index_2d(uint32_t x, uint32_t y){
+    uint32_t A, B, C, D;
+
+    {
+      const uint32_t a = x ^ y;
+      const uint32_t b = 0xFFFF ^ a;
+      const uint32_t c = 0xFFFF ^ (x | y);
+      const uint32_t d = x & (y ^ 0xFFFF);
+
+      A = a | (b >> 1);
+      B = (a >> 1) ^ a;
+      C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+      D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+    }
+
+    for (int shift = 2; shift <= 4; shift *= 2){
+      const uint32_t a = A, b = B, c = C, d = D;
+
+      A = (a & (a >> shift)) ^ (b & (b >> shift));
+      B = (a & (b >> shift)) ^ (b & ((a ^ b) >> shift));
+      C ^= (a & (c >> shift)) ^ (b & (d >> shift));
+      D ^= (b & (c >> shift)) ^ ((a ^ b) & (d >> shift));
+    }
+
+    {
+      const uint32_t a = A, b = B, c = C, d = D;
+      C ^= (a & (c >> 8)) ^ (b & (d >> 8));
+      D ^= (b & (c >> 8)) ^ ((a ^ b) & (d >> 8));
+    }
+
+    const uint32_t a = C ^ (C >> 1);
+    const uint32_t b = D ^ (D >> 1);
+
+    const uint32_t i0 = x ^ y;
+    const uint32_t i1 = b | (0xFFFF ^ (i0 | a));
+
+    return (interleave_bits(i1) << 1) | interleave_bits(i0);
+  }
+
+  // Keys of the points (x(i), y(i)) of [0, n) in their bounding box, whatever their layout
+  template <typename X, typename Y>
+  static std::vector<uint32_t> hilbert_keys(size_t n, const X& x, const Y& y, double min_x, double min_y, double max_x, double max_y){
+    std::vector<uint32_t> keys(n);
+
+    // Same scale on both axes to keep the curve cells square
+    const double extent = std::max(max_x - min_x, max_y - min_y);
+    const double scale = extent > 0 ? (hilbert_side - 1) / extent : 0;
+
+    #pragma omp parallel for
+    for (long i = 0; i < long(n); i++){
+      const uint32_t qx = uint32_t((x(i) - min_x) * scale);
+      const uint32_t qy = uint32_t((y(i) - min_y) * scale);
+      keys[i] = hilbert_index_2d(qx, qy);
+    }
+
+    return keys;
+  }
+
+  std::vector<uint32_t> hilbert_keys(const std::vector<Vector>& points){
+    if (points.empty()) return {};
+
+    double min_x = points[0][0], max_x = points[0][0];
+    double min_y = points[0][1], max_y = points[0][1];
+    for (const Vector& p : points){
+      min_x = std::min(min_x, p[0]);
+      max_x = std::max(max_x, p[0]);
+      min_y = std::min(min_y, p[1]);
+      max_y = std::max(max_y, p[1]);
+    }
+
+    return hilbert_keys(points.size(), [&](size_t i){ return points[i][0]; }, [&](size_t i){ return points[i][1]; },
+                        min_x, min_y, max_x, max_y);
+  }
+
+  template <typename Real>
+  std::vector<uint32_t> hilbert_keys(const VertexStore<Real>& points){
+    if (points.size() == 0) return {};
+
+    const auto [min_x, min_y, max_x, max_y] = points.planar_bounds();
+    return hilbert_keys(points.size(), [&](size_t i){ return points.x[i]; }, [&](size_t i){ return points.y[i]; },
+                        min_x, min_y, max_x, max_y);
+  }
+
+  // Sorts the indices in [begin, end) by key. The key and the index are packed
+  // in one integer when possible, it avoids the random accesses to keys while sorting
+  static void sort_by_key(const std::vector<uint32_t>& keys, std::vector<size_t>::iterator begin, std::vector<size_t>::iterator end){
+    if (keys.size() > std::numeric_limits<uint32_t>::max()){
+      std::sort(begin, end, [&](size_t a, size_t b){ return keys[a] < keys[b]; });
+      return;
+    }
+
+    std::vector<uint64_t> packed(end - begin);
+    for (size_t i = 0; i < packed.size(); i++)
+      packed[i] = uint64_t(keys[begin[i]]) << 32 | begin[i];
+
+    std::sort(packed.begin(), packed.end());
+
+    for (size_t i = 0; i < packed.size(); i++)
+      begin[i] = packed[i] & std::numeric_limits<uint32_t>::max();
+  }
+
+  std::vector<size_t> hilbert_order(const std::vector<Vector>& points){
+    const std::vector<uint32_t> keys = hilbert_keys(points);
+    std::vector<size_t> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    sort_by_key(keys, order.begin(), order.end());
+    return order;
+  }
+
+  template <typename Real>
+  std::vector<size_t> hilbert_order(const VertexStore<Real>& points){
+    const std::vector<uint32_t> keys = hilbert_keys(points);
+    std::vector<size_t> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    sort_by_key(keys, order.begin(), order.end());
+    return order;
+  }
+
+  template std::vector<uint32_t> hilbert_keys(const VertexStore<float>&);
+  template std::vector<uint32_t> hilbert_keys(const VertexStore<double>&);
+  template std::vector<size_t> hilbert_order(const VertexStore<float>&);
+  template std::vector<size_t> hilbert_order(const VertexStore<double>&);
+
+  static std::vector<size_t> brio_order(const std::vector<uint32_t>& keys, unsigned int seed){
+    // Rounds smaller than this are not worth sorting separately
+    constexpr size_t min_round = 64;
+
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+
+    // The last round holds half of the points, the one before a quarter, ...
+    size_t end = order.size();
+    while (end > 0){
+      const size_t begin = end > 2 * min_round ? end / 2 : 0;
+      sort_by_key(keys, order.begin() + begin, order.begin() + end);
+      end = begin;
+    }
+
+    return order;
+  }
+
+  std::vector<size_t> brio_order(const std::vector<Vector>& points, unsigned int seed){
+    return brio_order(hilbert_keys(points), seed);
+  }
+
+  // Skilling's transform : the coordinates become the transposed Hilbert index, whose bits are then interleaved
+  uint32_t hilbert_index_3d(uint32_t x, uint32_t y, uint32_t z){
+    constexpr uint32_t top = 1u << 9;
+    uint32_t X[3] = { x, y, z };
+
+    for (uint32_t q = top; q > 1; q >>= 1){
+      const uint32_t p = q - 1;
+      for (int i = 0; i < 3; i++){
+        if (X[i] & q)
+          X[0] ^= p;
+        else {
+          const uint32_t t = (X[0] ^ X[i]) & p;
+          X[0] ^= t;
+          X[i] ^= t;
+        }
+      }
+    }
+
+    // Gray code
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    uint32_t t = 0;
+    for (uint32_t q = top; q > 1; q >>= 1)
+      if (X[2] & q) t ^= q - 1;
+    for (uint32_t& c : X) c ^= t;
+
+    uint32_t index = 0;
+    for (int bit = 9; bit >= 0; bit--)
+      for (uint32_t c : X)
+        index = index << 1 | (c >> bit & 1);
+    return index;
+  }
+
+  std::vector<uint32_t> hilbert_keys_3d(const std::vector<Vector>& points){
+    constexpr uint32_t side = 1u << 10;
+    std::vector<uint32_t> keys(points.size());
+    if (points.empty()) return keys;
+
+    Vector low = points[0], high = points[0];
+    for (const Vector& p : points)
+      for (int i = 0; i < 3; i++){
+        low[i] = std::min(low[i], p[i]);
+        high[i] = std::max(high[i], p[i]);
+      }
+
+    // Same scale on all the axes, as in 2d
+    const double extent = std::max({ high[0] - low[0], high[1] - low[1], high[2] - low[2] });
+    const double scale = extent > 0 ? (side - 1) / extent : 0;
+
+    #pragma omp parallel for
+    for (long i = 0; i < long(points.size()); i++){
+      const Vector& p = points[i];
+      keys[i] = hilbert_index_3d(uint32_t((p[0] - low[0]) * scale), uint32_t((p[1] - low[1]) * scale), uint32_t((p[2] - low[2]) * scale));
+    }
+
+    return keys;
+  }
+
+  std::vector<size_t> hilbert_order_3d(const std::vector<Vector>& points){
+    const std::vector<uint32_t> keys = hilbert_keys_3d(points);
+    std::vector<size_t> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    sort_by_key(keys, order.begin(), order.end());
+    return order;
+  }
+
+  std::vector<size_t> brio_order_3d(const std::vector<Vector>& points, unsigned int seed){
+    return brio_order(hilbert_keys_3d(points), seed);
+  }
+}
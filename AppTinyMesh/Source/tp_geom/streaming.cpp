@@ -0,0 +1,587 @@
+#include <tp_geom/streaming.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// The triangles in memory are a Delaunay triangulation of the points read so far, minus the written triangles :
+// an edge of a written triangle has no triangle on the other side (size_t_max). A written triangle has its
+// circumcircle in finalized cells, no later point can be in conflict with it, so a cavity (Bowyer-Watson)
+// always stops before it.
+// Each triangle waits in the list of one open cell its circumcircle overlaps. When the cell is finalized
+// the next open cell is looked for, the triangle is written when there is none. The cells are grouped in
+// blocks that count their open cells, the finalized areas are skipped a block at a time
+
+namespace {
+  constexpr size_t block_size = 16;
+
+  template <typename T>
+  void write_raw(std::ostream& stream, const T& value){
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  bool read_raw(std::istream& stream, T& value){
+    return bool(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  // Cell column (or row) of a coordinate, clamped to the grid
+  size_t cell_coord(double v, double min, double size, size_t grid_size){
+    return size_t(std::clamp(std::floor((v - min) / size), 0., double(grid_size - 1)));
+  }
+}
+
+size_t StreamingDelaunay2D::StreamHeader::cell_of(double x, double y) const {
+  return cell_coord(y, y_min, (y_max - y_min) / grid_size, grid_size) * grid_size
+       + cell_coord(x, x_min, (x_max - x_min) / grid_size, grid_size);
+}
+
+StreamingDelaunay2D::FinalizeStats StreamingDelaunay2D::finalize(std::istream& cloud, std::ostream& stream, size_t points_per_cell){
+  FinalizeStats stats;
+  StreamHeader header;
+  const std::streampos start = cloud.tellg();
+
+  const auto for_each_point = [&](const auto& visit){
+    cloud.clear();
+    cloud.seekg(start);
+
+    size_t count = 0;
+    cloud >> count;
+
+    Vector p;
+    for (size_t i = 0; i < count && cloud >> p[0] >> p[1] >> p[2]; i++)
+      visit(p);
+  };
+
+  header.x_min = header.y_min = std::numeric_limits<double>::infinity();
+  header.x_max = header.y_max = -std::numeric_limits<double>::infinity();
+  for_each_point([&](const Vector& p){
+    header.point_count++;
+    header.x_min = std::min(header.x_min, p[0]);
+    header.y_min = std::min(header.y_min, p[1]);
+    header.x_max = std::max(header.x_max, p[0]);
+    header.y_max = std::max(header.y_max, p[1]);
+  });
+
+  // A flat cloud still needs cells of some width
+  if (header.point_count == 0) header.x_min = header.y_min = 0;
+  if (!(header.x_max > header.x_min)) header.x_max = header.x_min + 1;
+  if (!(header.y_max > header.y_min)) header.y_max = header.y_min + 1;
+
+  const double cells = double(header.point_count) / double(std::max<size_t>(1, points_per_cell));
+  header.grid_size = std::max<uint64_t>(1, uint64_t(std::ceil(std::sqrt(cells))));
+
+  std::vector<size_t> remaining(header.grid_size * header.grid_size, 0);
+  for_each_point([&](const Vector& p){ remaining[header.cell_of(p[0], p[1])]++; });
+
+  write_raw(stream, header);
+
+  // The empty cells are finalized from the start
+  for (size_t c = 0; c < remaining.size(); c++){
+    if (remaining[c] != 0) continue;
+    write_raw(stream, 'c');
+    write_raw(stream, uint64_t(c));
+    stats.cells++;
+  }
+
+  std::vector<char> opened(remaining.size(), false);
+  size_t open_cells = 0;
+
+  for_each_point([&](const Vector& p){
+    const size_t c = header.cell_of(p[0], p[1]);
+    if (!opened[c]){
+      opened[c] = true;
+      stats.max_open_cells = std::max(stats.max_open_cells, ++open_cells);
+    }
+
+    write_raw(stream, 'p');
+    write_raw(stream, p[0]);
+    write_raw(stream, p[1]);
+    write_raw(stream, p[2]);
+    stats.points++;
+
+    if (--remaining[c] == 0){
+      write_raw(stream, 'c');
+      write_raw(stream, uint64_t(c));
+      stats.cells++;
+      open_cells--;
+    }
+  });
+
+  return stats;
+}
+
+StreamingDelaunay2D::Stats StreamingDelaunay2D::triangulate(std::istream& stream, std::ostream& out_stream){
+  reset();
+  out = &out_stream;
+  if (!read_raw(stream, header)) return stats;
+
+  const size_t grid_size = header.grid_size;
+  cell_width = (header.x_max - header.x_min) / grid_size;
+  cell_height = (header.y_max - header.y_min) / grid_size;
+  finalized.assign(grid_size * grid_size, false);
+  waiting_head.assign(grid_size * grid_size, size_t_max);
+  cell_vertex.assign(grid_size * grid_size, size_t_max);
+
+  block_count = (grid_size + block_size - 1) / block_size;
+  block_open.assign(block_count * block_count, 0);
+  for (size_t row = 0; row < grid_size; row++)
+    for (size_t col = 0; col < grid_size; col++)
+      block_open[(row / block_size) * block_count + col / block_size]++;
+
+  char tag;
+  while (read_raw(stream, tag)){
+    if (tag == 'p'){
+      Vector p;
+      if (!read_raw(stream, p[0]) || !read_raw(stream, p[1]) || !read_raw(stream, p[2])) break;
+      add_point(p);
+    }
+    else if (tag == 'c'){
+      uint64_t cell;
+      if (!read_raw(stream, cell) || cell >= finalized.size()) break;
+      if (mesh.triangles.empty()) pending_cells.push_back(cell);
+      else finalize_cell(cell);
+    }
+    else
+      break;
+  }
+
+  flush();
+  out = nullptr;
+  return stats;
+}
+
+void StreamingDelaunay2D::reset(){
+  mesh = TriangleMesh();
+  stats = {};
+  waiting_prev.clear();
+  waiting_next.clear();
+  waiting_cell.clear();
+  output_id.assign(1, size_t_max);
+  live_tris.assign(1, 0);
+  cavity_state.clear();
+  pending_points.clear();
+  pending_cells.clear();
+  locate_hint = size_t_max;
+}
+
+void StreamingDelaunay2D::add_point(const Vector& point){
+  stats.points++;
+
+  if (mesh.triangles.empty()){
+    pending_points.push_back(point);
+    if (!init_first_triangle()) return;
+
+    for (const Vector& p : pending_points){
+      const size_t seed = locate(p);
+      if (seed == size_t_max || !insert(p, seed)) stats.duplicates++;
+    }
+
+    for (size_t cell : pending_cells)
+      finalize_cell(cell);
+
+    pending_points.clear();
+    pending_cells.clear();
+    return;
+  }
+
+  const size_t seed = locate(point);
+  if (seed == size_t_max || !insert(point, seed)) stats.duplicates++;
+}
+
+bool StreamingDelaunay2D::init_first_triangle(){
+  // The points before the last one are on a line, only the last one can make the first triangle
+  const std::vector<Vector>& p = pending_points;
+  size_t b = 1;
+  while (b < p.size() && p[b][0] == p[0][0] && p[b][1] == p[0][1]) b++;
+  if (b + 1 >= p.size()) return false;
+
+  size_t c = p.size() - 1;
+  const double orient = Predicates::orient_2d(p[0], p[b], p[c]);
+  if (orient == 0) return false;
+  if (orient < 0) std::swap(b, c);
+
+  const std::array<size_t, 3> v = { new_vertex(p[0]), new_vertex(p[b]), new_vertex(p[c]) };
+  const size_t f = new_triangle();
+  const std::array<size_t, 3> h = { new_triangle(), new_triangle(), new_triangle() };
+
+  // Hull triangle i is across the edge i of the finite one
+  mesh.triangles[f] = MTriangle(v, h);
+  mesh.triangles[h[0]] = MTriangle({ mesh.infinite_point, v[2], v[1] }, { f, h[2], h[1] });
+  mesh.triangles[h[1]] = MTriangle({ mesh.infinite_point, v[0], v[2] }, { f, h[0], h[2] });
+  mesh.triangles[h[2]] = MTriangle({ mesh.infinite_point, v[1], v[0] }, { f, h[1], h[0] });
+
+  mesh.vertex_to_triangle[mesh.infinite_point] = h[0];
+  for (size_t vertex : v){
+    mesh.vertex_to_triangle[vertex] = f;
+    live_tris[vertex] = 3;
+  }
+
+  // The other points are inserted in their reading order
+  const std::array<size_t, 3> used = { 0, std::min(b, c), std::max(b, c) };
+  for (size_t i = 3; i-- > 0;)
+    pending_points.erase(pending_points.begin() + used[i]);
+
+  locate_hint = f;
+  schedule(f);
+  return true;
+}
+
+// Visibility walk, it can't cross a written triangle. Returns size_t_max when it is stopped by one
+size_t StreamingDelaunay2D::walk(const Vector& point, size_t tri_id){
+  size_t previous = size_t_max;
+
+  while (tri_id != size_t_max && !mesh.triangles[tri_id].is_free()){
+    const MTriangle& tri = mesh.triangles[tri_id];
+    const LocalId<3> inf_id = tri.local_id_of(mesh.infinite_point);
+    if (inf_id.is_valid()){
+      if (in_conflict(tri_id, point)) return tri_id;
+      previous = tri_id;
+      tri_id = tri.opposite_triangle[inf_id];
+      continue;
+    }
+
+    coin ^= coin << 13;
+    coin ^= coin >> 17;
+    coin ^= coin << 5;
+
+    size_t next = size_t_max;
+    bool blocked = false;
+    for (int k = 0; k < 3 && next == size_t_max; k++){
+      const LocalId<3> e = LocalId<3>(coin % 3) + k;
+      const size_t o_tri_id = tri.opposite_triangle[e];
+      if (previous != size_t_max && o_tri_id == previous) continue;
+
+      if (Predicates::orient_2d(mesh.get_vertex(tri, e + 1), mesh.get_vertex(tri, e + 2), point) < 0){
+        if (o_tri_id == size_t_max) blocked = true;
+        else next = o_tri_id;
+      }
+    }
+
+    if (next == size_t_max)
+      return blocked ? size_t_max : tri_id;
+
+    previous = tri_id;
+    tri_id = next;
+  }
+
+  return size_t_max;
+}
+
+// Jump and walk : from the last new triangle, or from the last vertex inserted in the cell of the point if it is
+// closer. The triangles over an open cell are all in memory, when the walk is stopped it starts again from the
+// vertices of the open cells around, then from a triangle waiting for the cell. The front is scanned as a last resort
+size_t StreamingDelaunay2D::locate(const Vector& point){
+  const size_t grid_size = header.grid_size;
+  const size_t cell = header.cell_of(point[0], point[1]);
+  const size_t row = cell / grid_size, col = cell % grid_size;
+
+  // The first vertex of a new triangle is the last inserted point
+  size_t start = locate_hint;
+  const size_t anchor = cell_vertex[cell];
+  if (anchor != size_t_max && (start == size_t_max || mesh.triangles[start].is_free()
+      || squared_distance_2d(mesh.vertices[anchor], point) < squared_distance_2d(mesh.get_vertex(mesh.triangles[start], 0), point)))
+    start = mesh.vertex_to_triangle[anchor];
+
+  size_t tri_id = walk(point, start);
+  if (tri_id != size_t_max) return tri_id;
+
+  for (size_t r = row - std::min<size_t>(row, 1); r <= std::min(grid_size - 1, row + 1); r++)
+    for (size_t c = col - std::min<size_t>(col, 1); c <= std::min(grid_size - 1, col + 1); c++){
+      const size_t near = r * grid_size + c;
+      if (finalized[near] || cell_vertex[near] == size_t_max) continue;
+
+      tri_id = walk(point, mesh.vertex_to_triangle[cell_vertex[near]]);
+      if (tri_id != size_t_max) return tri_id;
+    }
+
+  tri_id = walk(point, waiting_head[cell]);
+  if (tri_id != size_t_max) return tri_id;
+
+  stats.scans++;
+  for (size_t t = 0; t < mesh.triangles.size(); t++)
+    if (!mesh.triangles[t].is_free() && in_conflict(t, point)) return t;
+
+  return size_t_max;
+}
+
+// Same rule as the Cavity kernel of DelaunayTriangulation2D : an hull triangle conflicts when the point is
+// strictly outside of its edge, or on the edge line and in the circumcircle of the finite triangle behind
+bool StreamingDelaunay2D::in_conflict(size_t tri_id, const Vector& point) const {
+  const MTriangle& tri = mesh.triangles[tri_id];
+  const LocalId<3> inf_id = tri.local_id_of(mesh.infinite_point);
+  if (!inf_id.is_valid())
+    return in_circle_2d(mesh.get_vertices(tri), point) > 0;
+
+  const double hull_orient = Predicates::orient_2d(mesh.get_vertex(tri, inf_id + 1), mesh.get_vertex(tri, inf_id + 2), point);
+  if (hull_orient != 0)
+    return hull_orient > 0;
+
+  const size_t finite = tri.opposite_triangle[inf_id];
+  return finite != size_t_max && in_circle_2d(mesh.get_vertices(mesh.triangles[finite]), point) > 0;
+}
+
+bool StreamingDelaunay2D::insert(const Vector& point, size_t seed){
+  enum : char { Unknown = 0, Inside = 1, Outside = 2 };
+  cavity.clear();
+  cavity_rejected.clear();
+  star.clear();
+
+  cavity.push_back(seed);
+  cavity_state[seed] = Inside;
+
+  for (size_t i = 0; i < cavity.size(); i++){
+    const MTriangle& tri = mesh.triangles[cavity[i]];
+
+    for (int e = 0; e < 3; e++){
+      const size_t o_tri_id = tri.opposite_triangle[e];
+      char state = Outside;
+
+      if (o_tri_id != size_t_max){
+        state = cavity_state[o_tri_id];
+        if (state == Unknown){
+          state = cavity_state[o_tri_id] = in_conflict(o_tri_id, point) ? Inside : Outside;
+          (state == Inside ? cavity : cavity_rejected).push_back(o_tri_id);
+        }
+      }
+
+      if (state == Outside){
+        const auto [a, b] = tri.get_edge(e);
+        star.push_back({ a, b, o_tri_id, size_t_max });
+      }
+    }
+  }
+
+  for (size_t t : cavity) cavity_state[t] = Unknown;
+  for (size_t t : cavity_rejected) cavity_state[t] = Unknown;
+
+  // A point on a vertex leaves the vertex on the boundary of the cavity
+  for (const StarTri& st : star){
+    const Vector& a = mesh.vertices[st.a];
+    if (st.a != mesh.infinite_point && a[0] == point[0] && a[1] == point[1]) return false;
+  }
+
+  // The exact predicates give a disk seen by the point, c triangles and c + 2 edges
+  assert(star.size() == cavity.size() + 2);
+
+  // New triangle i is (point, a, b) where (a, b) is the boundary edge i, it takes the slot of a cavity triangle
+  for (size_t i = 0; i < star.size(); i++)
+    star[i].slot = i < cavity.size() ? cavity[i] : size_t_max;
+
+  for (size_t t : cavity){
+    unlink_waiting(t);
+    for (size_t v : mesh.triangles[t].vertices)
+      if (v != mesh.infinite_point) live_tris[v]--;
+  }
+
+  const size_t point_id = new_vertex(point);
+  for (size_t i = cavity.size(); i < star.size(); i++)
+    star[i].slot = new_triangle();
+
+  star_by_a.resize(star.size());
+  for (size_t i = 0; i < star.size(); i++)
+    star_by_a[i] = { star[i].a, i };
+  std::sort(star_by_a.begin(), star_by_a.end());
+
+  for (const StarTri& st : star){
+    const auto next = std::lower_bound(star_by_a.begin(), star_by_a.end(), std::pair<size_t, size_t>{ st.b, 0 });
+    assert(next != star_by_a.end() && next->first == st.b);
+    const size_t next_slot = star[next->second].slot;
+
+    MTriangle& tri = mesh.triangles[st.slot];
+    tri.vertices = { point_id, st.a, st.b };
+    tri.opposite_triangle[0] = st.outer;
+    tri.opposite_triangle[1] = next_slot;
+    tri.constraints = 0;
+    mesh.triangles[next_slot].opposite_triangle[2] = st.slot;
+
+    if (st.outer != size_t_max){
+      MTriangle& outer = mesh.triangles[st.outer];
+      outer.opposite_triangle[outer.find_edge(st.a, st.b)] = st.slot;
+    }
+
+    mesh.vertex_to_triangle[st.a] = st.slot;
+    for (size_t v : tri.vertices)
+      if (v != mesh.infinite_point) live_tris[v]++;
+  }
+
+  const size_t cell = header.cell_of(point[0], point[1]);
+  mesh.vertex_to_triangle[point_id] = star[0].slot;
+  cell_vertex[cell] = point_id;
+  locate_hint = star[0].slot;
+
+  // The circumcircles go through the point, its cell is open : the circles are only looked at once it is finalized
+  for (const StarTri& st : star)
+    if (st.a != mesh.infinite_point && st.b != mesh.infinite_point)
+      wait(st.slot, cell);
+
+  stats.max_triangles = std::max(stats.max_triangles, mesh.triangles.size() - mesh.free_triangles.size());
+  stats.max_vertices = std::max(stats.max_vertices, mesh.vertices.size() - TriangleMesh::v_start_offset - mesh.free_vertices.size());
+  return true;
+}
+
+size_t StreamingDelaunay2D::new_vertex(const Vector& point){
+  const size_t vertex = mesh.add_point(point);
+  if (vertex >= output_id.size()){
+    output_id.resize(mesh.vertices.size());
+    live_tris.resize(mesh.vertices.size());
+  }
+
+  output_id[vertex] = size_t_max;
+  live_tris[vertex] = 0;
+  return vertex;
+}
+
+size_t StreamingDelaunay2D::new_triangle(){
+  const size_t tri_id = mesh.add_triangle();
+  if (tri_id >= waiting_cell.size()){
+    waiting_prev.resize(mesh.triangles.size(), size_t_max);
+    waiting_next.resize(mesh.triangles.size(), size_t_max);
+    waiting_cell.resize(mesh.triangles.size(), size_t_max);
+    cavity_state.resize(mesh.triangles.size(), 0);
+  }
+
+  waiting_cell[tri_id] = size_t_max;
+  return tri_id;
+}
+
+// A vertex without triangles left in memory can't get new ones, the cavities don't reach it anymore
+void StreamingDelaunay2D::release_triangle(size_t tri_id){
+  unlink_waiting(tri_id);
+
+  for (size_t v : mesh.triangles[tri_id].vertices){
+    if (v == mesh.infinite_point || --live_tris[v] != 0) continue;
+
+    if (output_id[v] != size_t_max){
+      write_raw(*out, 'x');
+      write_raw(*out, uint64_t(output_id[v]));
+    }
+    output_id[v] = size_t_max;
+    mesh.remove_point(v);
+  }
+
+  mesh.remove_triangle(tri_id);
+}
+
+void StreamingDelaunay2D::schedule(size_t tri_id){
+  const size_t cell = first_open_cell(tri_id);
+  if (cell == size_t_max){
+    write_triangle(tri_id);
+    return;
+  }
+
+  wait(tri_id, cell);
+}
+
+void StreamingDelaunay2D::wait(size_t tri_id, size_t cell){
+  waiting_cell[tri_id] = cell;
+  waiting_prev[tri_id] = size_t_max;
+  waiting_next[tri_id] = waiting_head[cell];
+  if (waiting_head[cell] != size_t_max) waiting_prev[waiting_head[cell]] = tri_id;
+  waiting_head[cell] = tri_id;
+}
+
+size_t StreamingDelaunay2D::first_open_cell(size_t tri_id) const {
+  const size_t grid_size = header.grid_size;
+  const std::array<Vector, 3> p = mesh.get_vertices(mesh.triangles[tri_id]);
+  const Vector center = circumcenter_2d(p);
+
+  // Widened for the rounding of the center and of the cells of the points, a flat triangle covers everything
+  double radius = std::sqrt(squared_distance_2d(center, p[0]));
+  radius = std::isfinite(radius) ? radius * (1 + 1e-6) + 1e-9 * (cell_width + cell_height) : std::numeric_limits<double>::infinity();
+  const double cx = std::isfinite(radius) ? center[0] : (header.x_min + header.x_max) / 2;
+  const double cy = std::isfinite(radius) ? center[1] : (header.y_min + header.y_max) / 2;
+
+  if (cx + radius < header.x_min || cx - radius > header.x_max || cy + radius < header.y_min || cy - radius > header.y_max)
+    return size_t_max;
+
+  const size_t col_begin = cell_coord(cx - radius, header.x_min, cell_width, grid_size);
+  const size_t col_end = cell_coord(cx + radius, header.x_min, cell_width, grid_size) + 1;
+  const size_t row_begin = cell_coord(cy - radius, header.y_min, cell_height, grid_size);
+  const size_t row_end = cell_coord(cy + radius, header.y_min, cell_height, grid_size) + 1;
+
+  for (size_t block_row = row_begin / block_size; block_row * block_size < row_end; block_row++)
+    for (size_t block_col = col_begin / block_size; block_col * block_size < col_end; block_col++){
+      if (block_open[block_row * block_count + block_col] == 0) continue;
+
+      const size_t r_end = std::min(row_end, (block_row + 1) * block_size);
+      const size_t c_end = std::min(col_end, (block_col + 1) * block_size);
+
+      for (size_t row = std::max(row_begin, block_row * block_size); row < r_end; row++)
+        for (size_t col = std::max(col_begin, block_col * block_size); col < c_end; col++){
+          const size_t cell = row * grid_size + col;
+          if (finalized[cell]) continue;
+
+          // Distance from the center to the cell rectangle
+          const double x0 = header.x_min + col * cell_width, y0 = header.y_min + row * cell_height;
+          const double dx = std::max({ x0 - cx, 0., cx - x0 - cell_width });
+          const double dy = std::max({ y0 - cy, 0., cy - y0 - cell_height });
+          if (dx * dx + dy * dy <= radius * radius) return cell;
+        }
+    }
+
+  return size_t_max;
+}
+
+void StreamingDelaunay2D::unlink_waiting(size_t tri_id){
+  const size_t cell = waiting_cell[tri_id];
+  if (cell == size_t_max) return;
+
+  const size_t prev = waiting_prev[tri_id], next = waiting_next[tri_id];
+  (prev == size_t_max ? waiting_head[cell] : waiting_next[prev]) = next;
+  if (next != size_t_max) waiting_prev[next] = prev;
+  waiting_cell[tri_id] = size_t_max;
+}
+
+void StreamingDelaunay2D::finalize_cell(size_t cell){
+  if (finalized[cell]) return;
+  finalized[cell] = true;
+  block_open[(cell / header.grid_size / block_size) * block_count + cell % header.grid_size / block_size]--;
+
+  while (waiting_head[cell] != size_t_max){
+    const size_t tri_id = waiting_head[cell];
+    unlink_waiting(tri_id);
+    schedule(tri_id);
+  }
+}
+
+void StreamingDelaunay2D::write_triangle(size_t tri_id){
+  MTriangle& tri = mesh.triangles[tri_id];
+
+  for (size_t v : tri.vertices){
+    if (output_id[v] != size_t_max) continue;
+    output_id[v] = stats.vertices++;
+    write_raw(*out, 'v');
+    write_raw(*out, mesh.vertices[v][0]);
+    write_raw(*out, mesh.vertices[v][1]);
+    write_raw(*out, mesh.vertices[v][2]);
+  }
+
+  write_raw(*out, 'f');
+  for (size_t v : tri.vertices)
+    write_raw(*out, uint64_t(output_id[v]));
+  stats.triangles++;
+
+  for (int e = 0; e < 3; e++){
+    const size_t o_tri_id = tri.opposite_triangle[e];
+    if (o_tri_id == size_t_max) continue;
+
+    MTriangle& o_tri = mesh.triangles[o_tri_id];
+    o_tri.opposite_triangle[o_tri.find_edge(tri.get_edge(e))] = size_t_max;
+  }
+
+  release_triangle(tri_id);
+}
+
+// End of the stream : the triangles left are written (all of them were already if every cell was finalized),
+// the hull triangles are dropped
+void StreamingDelaunay2D::flush(){
+  for (size_t t = 0; t < mesh.triangles.size(); t++)
+    if (!mesh.triangles[t].is_free() && !mesh.triangles[t].is_infinite())
+      write_triangle(t);
+
+  for (size_t t = 0; t < mesh.triangles.size(); t++)
+    if (!mesh.triangles[t].is_free())
+      release_triangle(t);
+
+  locate_hint = size_t_max;
+}
@@ -0,0 +1,92 @@
+#include <tp_geom/tet_mesh.h>
+#include <tp_geom/predicates.h>
+#include <algorithm>
+#include <stdexcept>
+
+TetMesh::TetMesh(){
+  constexpr double inf = std::numeric_limits<double>::infinity();
+  vertices.assign(1, Vector{0, 0, inf});
+  vertex_to_tet.assign(1, size_t_max);
+}
+
+void TetMesh::check_size(size_t vertex_count, size_t tet_count){
+  constexpr size_t max_ids = std::numeric_limits<MeshIndex>::max();
+  if (vertex_count > max_ids || tet_count > max_ids)
+    throw std::length_error("TetMesh : more vertices or tets than its ids can hold, see TP_GEOM_INDEX_64");
+}
+
+size_t TetMesh::add_point(const Vector& point){
+  check_size(vertices.size() + 1, 0);
+  vertices.push_back(point);
+  vertex_to_tet.push_back(size_t_max);
+  return vertices.size() - 1;
+}
+
+size_t TetMesh::add_tet(){
+  if (!free_tets.empty()){
+    const size_t ret = free_tets.back();
+    free_tets.pop_back();
+    return ret;
+  }
+
+  check_size(0, tets.size() + 1);
+  tets.emplace_back();
+  return tets.size() - 1;
+}
+
+void TetMesh::remove_tet(size_t tet_id){
+  assert(!tets[tet_id].is_free());
+  tets[tet_id] = MTet();
+  free_tets.push_back(tet_id);
+}
+
+size_t TetMesh::finite_tet_count() const {
+  return std::count_if(tets.begin(), tets.end(), [](const MTet& t){ return !t.is_free() && !t.is_infinite(); });
+}
+
+void TetMesh::clear(){
+  *this = TetMesh();
+}
+
+void assert_tet_mesh_valid(const TetMesh& m){
+#ifndef NDEBUG
+  size_t free_count = 0;
+
+  for (size_t tet_id = 0; tet_id < m.tets.size(); tet_id++){
+    const MTet& tet = m.tets[tet_id];
+    if (tet.is_free()){
+      free_count++;
+      continue;
+    }
+
+    for (int i = 0; i < 4; i++){
+      assert(tet.vertices[i] < m.vertices.size());
+      for (int j = i + 1; j < 4; j++)
+        assert(tet.vertices[i] != tet.vertices[j]);
+
+      // The neighbour shares the 3 other vertices and points back
+      const size_t o = tet.opposite_tet[i];
+      assert(o < m.tets.size() && !m.tets[o].is_free());
+      const MTet& other = m.tets[o];
+      const LocalId<4> back = other.face_towards(tet_id);
+      assert(back.is_valid());
+      for (int j = 0; j < 4; j++)
+        assert(j == i || other.local_id_of(tet.vertices[j]).is_valid());
+      assert(!other.local_id_of(tet.vertices[i]).is_valid());
+    }
+
+    if (!tet.is_infinite()){
+      const auto p = m.get_vertices(tet);
+      assert(Predicates::orient_3d(p[0], p[1], p[2], p[3]) > 0);
+    }
+  }
+
+  assert(free_count == m.free_tets.size());
+
+  for (size_t v = 0; v < m.vertices.size(); v++){
+    const size_t tet_id = m.vertex_to_tet[v];
+    if (tet_id == size_t_max) continue;
+    assert(tet_id < m.tets.size() && m.tets[tet_id].local_id_of(v).is_valid());
+  }
+#endif
+}
@@ -0,0 +1,438 @@
+#include <tp_geom/tiling.h>
+#include <tp_geom/seam_stitch.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+// Stitch :
+// - the kept triangles of a tile are linked together by the tile, the edges left open are matched between
+//   the tiles by sorting them. An edge matched by no other tile bounds a kept area
+// - the seam is made of the ends of these edges, and of the points in no kept triangle. A point whose star
+//   isn't fully kept is in one of the two cases, so the seam holds all the vertices of the missing triangles,
+//   and its Delaunay triangulation has them
+// - as in build_parallel, SeamStitch::fill_holes drops the seam triangles covering the kept areas and fills
+//   the holes with the others
+
+namespace {
+  constexpr size_t no_tile = size_t_max;
+
+  template <typename T>
+  void write_raw(std::ostream& stream, const T& value){
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  bool read_raw(std::istream& stream, T& value){
+    return bool(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  // Column (or row) of a coordinate, clamped to the grid
+  size_t grid_coord(double v, double min, double size, size_t count){
+    if (!(size > 0)) return 0;
+    return size_t(std::clamp(std::floor((v - min) / size), 0., double(count - 1)));
+  }
+
+  // The point clamped to the xy bounds of the manifest
+  std::pair<double, double> clamped(const TileManifest& manifest, const Vector& p){
+    return { std::clamp(p[0], manifest.bounds[0][0], manifest.bounds[1][0]),
+             std::clamp(p[1], manifest.bounds[0][1], manifest.bounds[1][1]) };
+  }
+
+  // Tile keeping the triangle : the one whose core holds the circumcenter, if the circumcircle is inside its buffer.
+  // The caller starts from the smallest vertex id, so every tile computes the same center for a triangle
+  size_t keeping_tile(const TileManifest& manifest, const std::array<Vector, 3>& tri){
+    SeamStitch::Circle circle;
+    if (!SeamStitch::circumcircle(tri, circle)) return no_tile;
+
+    const size_t id = manifest.tile_of(circle.x, circle.y);
+    const Box buffer = manifest.tile(id).buffer;
+    return circle.inside(buffer[0][0], buffer[0][1], buffer[1][0], buffer[1][1]) ? id : no_tile;
+  }
+
+  // Vertices of a triangle from the smallest id, same orientation
+  std::array<Vector, 3> canonical_vertices(const TriangleMesh& mesh, const MTriangle& tri){
+    const LocalId<3> first(int(std::min_element(tri.vertices.begin(), tri.vertices.end()) - tri.vertices.begin()));
+    return { mesh.vertices[tri.vertices[first]], mesh.vertices[tri.vertices[first + 1]], mesh.vertices[tri.vertices[first + 2]] };
+  }
+
+  // Edge of a kept triangle without a kept triangle of the same tile on the other side
+  struct OpenEdge {
+    size_t a, b; // a < b
+    size_t tri;  // In the stitched mesh
+    char edge;
+  };
+}
+
+TileManifest::TileManifest(const Box& bounds, double tile_size, double margin): bounds(bounds), margin(margin) {
+  const auto count = [&](int axis){
+    const double extent = bounds[1][axis] - bounds[0][axis];
+    return extent > 0 && tile_size > 0 ? std::max<size_t>(1, size_t(std::ceil(extent / tile_size))) : 1;
+  };
+
+  columns = count(0);
+  rows = count(1);
+}
+
+TileManifest::Tile TileManifest::tile(size_t id) const {
+  const double w = (bounds[1][0] - bounds[0][0]) / columns, h = (bounds[1][1] - bounds[0][1]) / rows;
+  const size_t col = id % columns, row = id / columns;
+
+  Tile tile;
+  tile.core = Box(Vector(bounds[0][0] + col * w, bounds[0][1] + row * h, bounds[0][2]),
+                  Vector(bounds[0][0] + (col + 1) * w, bounds[0][1] + (row + 1) * h, bounds[1][2]));
+  tile.buffer = Box(tile.core[0] - Vector(margin, margin, 0), tile.core[1] + Vector(margin, margin, 0));
+  return tile;
+}
+
+size_t TileManifest::tile_of(double x, double y) const {
+  return grid_coord(y, bounds[0][1], (bounds[1][1] - bounds[0][1]) / rows, rows) * columns
+       + grid_coord(x, bounds[0][0], (bounds[1][0] - bounds[0][0]) / columns, columns);
+}
+
+std::vector<size_t> TileManifest::tiles_over(const Box& area) const {
+  std::vector<size_t> ids;
+  for (size_t id = 0; id < size(); id++){
+    const Box buffer = tile(id).buffer;
+    if (area[0][0] <= buffer[1][0] && area[1][0] >= buffer[0][0] && area[0][1] <= buffer[1][1] && area[1][1] >= buffer[0][1])
+      ids.push_back(id);
+  }
+
+  return ids;
+}
+
+std::vector<size_t> TileManifest::buffer_points(const std::vector<Vector>& points, size_t id) const {
+  const Box buffer = tile(id).buffer;
+  std::vector<size_t> ids;
+
+  for (size_t i = 0; i < points.size(); i++){
+    const auto [x, y] = clamped(*this, points[i]);
+    if (x >= buffer[0][0] && x <= buffer[1][0] && y >= buffer[0][1] && y <= buffer[1][1])
+      ids.push_back(i);
+  }
+
+  return ids;
+}
+
+void TileManifest::write(std::ostream& stream) const {
+  const auto precision = stream.precision(17);
+  stream << columns << " " << rows << " " << margin << "\n";
+  stream << bounds[0][0] << " " << bounds[0][1] << " " << bounds[0][2] << " "
+         << bounds[1][0] << " " << bounds[1][1] << " " << bounds[1][2] << "\n";
+
+  for (size_t id = 0; id < size(); id++){
+    const Tile t = tile(id);
+    stream << id << " " << t.core[0][0] << " " << t.core[0][1] << " " << t.core[1][0] << " " << t.core[1][1]
+           << " " << t.buffer[0][0] << " " << t.buffer[0][1] << " " << t.buffer[1][0] << " " << t.buffer[1][1] << "\n";
+  }
+
+  stream.precision(precision);
+}
+
+bool TileManifest::read(std::istream& stream, TileManifest& result){
+  TileManifest manifest;
+  Vector low, high;
+  if (!(stream >> manifest.columns >> manifest.rows >> manifest.margin)) return false;
+  if (!(stream >> low[0] >> low[1] >> low[2] >> high[0] >> high[1] >> high[2])) return false;
+
+  // A negative count reads as a huge one, the product must still fit
+  const size_t max_count = std::numeric_limits<size_t>::max();
+  if (manifest.columns == 0 || manifest.rows == 0 || manifest.columns > max_count / manifest.rows) return false;
+  if (!std::isfinite(manifest.margin) || manifest.margin < 0) return false;
+  for (int axis = 0; axis < 3; axis++)
+    if (!std::isfinite(low[axis]) || !std::isfinite(high[axis]) || low[axis] > high[axis]) return false;
+
+  manifest.bounds = Box(low, high);
+  result = manifest;
+  return true;
+}
+
+void TiledDelaunay2D::TileTriangulation::write(std::ostream& stream) const {
+  write_raw(stream, uint64_t(tile));
+  write_raw(stream, uint64_t(triangles.size()));
+
+  for (const MTriangle& tri : triangles){
+    for (size_t v : tri.vertices) write_raw(stream, uint64_t(v));
+    for (size_t o : tri.opposite_triangle) write_raw(stream, uint64_t(o));
+  }
+}
+
+bool TiledDelaunay2D::TileTriangulation::read(std::istream& stream, TileTriangulation& result){
+  uint64_t tile, count, value;
+  if (!read_raw(stream, tile) || !read_raw(stream, count)) return false;
+
+  result.tile = tile;
+  result.triangles.resize(count);
+  for (MTriangle& tri : result.triangles){
+    for (auto& v : tri.vertices){
+      if (!read_raw(stream, value)) return false;
+      v = value;
+    }
+    for (auto& o : tri.opposite_triangle){
+      if (!read_raw(stream, value)) return false;
+      o = value;
+    }
+  }
+
+  return true;
+}
+
+TiledDelaunay2D::TileTriangulation TiledDelaunay2D::triangulate_tile(const std::vector<Vector>& points, const TileManifest& manifest,
+                                                                      size_t tile, Kernel kernel){
+  TileTriangulation result;
+  result.tile = tile;
+
+  const std::vector<size_t> ids = manifest.buffer_points(points, tile);
+  std::vector<Vector> tile_points(ids.size());
+  for (size_t i = 0; i < ids.size(); i++)
+    tile_points[i] = points[ids[i]];
+
+  DelaunayTriangulation2D tri(kernel);
+  const std::vector<size_t> local_ids = tri.build(tile_points);
+  const TriangleMesh& m = tri.get_mesh();
+  if (m.triangles.empty()) return result;
+
+  // Local vertex -> vertex of the stitched mesh. Through it the local ids follow the order of the
+  // global ones, the canonical vertices of a triangle are the same in every tile.
+  // The copies of a point share its local vertex, every tile gives it to the first copy
+  std::vector<size_t> to_global(m.vertices.size(), TriangleMesh::infinite_point);
+  for (size_t i = 0; i < local_ids.size(); i++)
+    if (to_global[local_ids[i]] == TriangleMesh::infinite_point)
+      to_global[local_ids[i]] = ids[i] + TriangleMesh::v_start_offset;
+
+  std::vector<size_t> kept(m.triangles.size(), size_t_max);
+  for (size_t t = 0; t < m.triangles.size(); t++){
+    const MTriangle& mt = m.triangles[t];
+    if (mt.is_free() || mt.is_infinite()) continue;
+
+    MTriangle global({ to_global[mt.vertices[0]], to_global[mt.vertices[1]], to_global[mt.vertices[2]] });
+    const LocalId<3> first(int(std::min_element(global.vertices.begin(), global.vertices.end()) - global.vertices.begin()));
+    const std::array<Vector, 3> p = { m.vertices[mt.vertices[first]], m.vertices[mt.vertices[first + 1]], m.vertices[mt.vertices[first + 2]] };
+
+    if (keeping_tile(manifest, p) == tile){
+      kept[t] = result.triangles.size();
+      result.triangles.push_back(global);
+    }
+  }
+
+  for (size_t t = 0; t < m.triangles.size(); t++){
+    if (kept[t] == size_t_max) continue;
+    for (int e = 0; e < 3; e++)
+      result.triangles[kept[t]].opposite_triangle[e] = kept[m.triangles[t].opposite_triangle[e]];
+  }
+
+  return result;
+}
+
+std::vector<size_t> TiledDelaunay2D::build(const std::vector<Vector>& points){
+  tiles.clear();
+  std::vector<size_t> all(manifest.size());
+  std::iota(all.begin(), all.end(), 0);
+  return update(points, all);
+}
+
+std::vector<size_t> TiledDelaunay2D::update(const std::vector<Vector>& points, const std::vector<size_t>& dirty){
+  std::vector<size_t> to_run = dirty;
+  std::sort(to_run.begin(), to_run.end());
+  to_run.erase(std::unique(to_run.begin(), to_run.end()), to_run.end());
+  if (tiles.size() != manifest.size()){
+    tiles.assign(manifest.size(), {});
+    to_run.resize(manifest.size());
+    std::iota(to_run.begin(), to_run.end(), 0);
+  }
+
+  #pragma omp parallel for schedule(dynamic)
+  for (long i = 0; i < long(to_run.size()); i++)
+    tiles[to_run[i]] = triangulate_tile(points, manifest, to_run[i], kernel);
+
+  stats = {};
+  stats.tiles_run = to_run.size();
+  return stitch_or_fallback(points);
+}
+
+std::vector<size_t> TiledDelaunay2D::stitch(const std::vector<Vector>& points, std::vector<TileTriangulation> results){
+  std::sort(results.begin(), results.end(), [](const TileTriangulation& a, const TileTriangulation& b){ return a.tile < b.tile; });
+  assert(results.size() == manifest.size());
+  for (size_t i = 0; i < results.size(); i++)
+    assert(results[i].tile == i);
+
+  tiles = std::move(results);
+  stats = {};
+  return stitch_or_fallback(points);
+}
+
+std::vector<size_t> TiledDelaunay2D::stitch_or_fallback(const std::vector<Vector>& points){
+  std::vector<size_t> ids;
+  if (stitch_tiles(points, ids))
+    return ids;
+
+  stats.fallback = true;
+  DelaunayTriangulation2D tri(kernel);
+  ids = tri.build(points);
+  mesh = tri.extract_mesh();
+  return ids;
+}
+
+bool TiledDelaunay2D::stitch_tiles(const std::vector<Vector>& points, std::vector<size_t>& ids){
+  // Numbering of the kept triangles, tile by tile
+  std::vector<size_t> tile_offsets(tiles.size() + 1, 0);
+  for (size_t i = 0; i < tiles.size(); i++)
+    tile_offsets[i + 1] = tile_offsets[i] + tiles[i].triangles.size();
+  const size_t kept_count = tile_offsets.back();
+  stats.kept = kept_count;
+
+  const size_t vertex_count = points.size() + TriangleMesh::v_start_offset;
+  TriangleMesh::check_size(vertex_count, kept_count);
+  std::vector<MTriangle> kept(kept_count);
+  std::vector<char> covered(vertex_count, 0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (long i = 0; i < long(tiles.size()); i++){
+    for (size_t t = 0; t < tiles[i].triangles.size(); t++){
+      MTriangle tri = tiles[i].triangles[t];
+      for (auto& o : tri.opposite_triangle)
+        if (o != size_t_max) o = { o + tile_offsets[i], o.edge() };
+      kept[tile_offsets[i] + t] = tri;
+    }
+  }
+
+  // Open edges, the two sides of an edge shared by two tiles are next to each other once sorted
+  std::vector<OpenEdge> open;
+  for (size_t t = 0; t < kept_count; t++){
+    const MTriangle& tri = kept[t];
+    for (char e = 0; e < 3; e++){
+      if (tri.vertices[e] >= vertex_count) return false;
+      covered[tri.vertices[e]] = 1;
+      if (tri.opposite_triangle[e] != size_t_max) continue;
+
+      const auto [a, b] = tri.get_edge(e);
+      open.push_back({ std::min(a, b), std::max(a, b), t, e });
+    }
+  }
+
+  std::sort(open.begin(), open.end(), [](const OpenEdge& l, const OpenEdge& r){ return l.a != r.a ? l.a < r.a : l.b < r.b; });
+
+  std::vector<char> in_seam(vertex_count, 0);
+
+  for (size_t i = 0; i < open.size(); ){
+    size_t j = i + 1;
+    while (j < open.size() && open[j].a == open[i].a && open[j].b == open[i].b) j++;
+
+    // Matched by no other tile, the edge bounds a kept area and stays open
+    if (j - i == 1)
+      in_seam[open[i].a] = in_seam[open[i].b] = 1;
+    else {
+      // Two tiles kept the same side of the edge, their triangles overlap
+      if (j - i > 2 || kept[open[i].tri].get_edge(open[i].edge) == kept[open[i + 1].tri].get_edge(open[i + 1].edge))
+        return false;
+      kept[open[i].tri].opposite_triangle[open[i].edge] = open[i + 1].tri;
+      kept[open[i + 1].tri].opposite_triangle[open[i + 1].edge] = open[i].tri;
+    }
+
+    i = j;
+  }
+
+  // The other copies of a point are in no kept triangle, they get the vertex of the copy a tile kept
+  ids.resize(points.size());
+  std::iota(ids.begin(), ids.end(), TriangleMesh::v_start_offset);
+  const auto xy_less = [&](size_t u, size_t v){ return std::make_pair(points[u][0], points[u][1]) < std::make_pair(points[v][0], points[v][1]); };
+
+  std::vector<size_t> uncovered;
+  for (size_t i = 0; i < points.size(); i++)
+    if (!covered[i + TriangleMesh::v_start_offset]) uncovered.push_back(i);
+  std::sort(uncovered.begin(), uncovered.end(), xy_less);
+
+  if (!uncovered.empty()){
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < long(points.size()); i++){
+      if (!covered[i + TriangleMesh::v_start_offset]) continue;
+      const auto [first, last] = std::equal_range(uncovered.begin(), uncovered.end(), size_t(i), xy_less);
+      for (auto it = first; it != last; it++)
+        ids[*it] = i + TriangleMesh::v_start_offset;
+    }
+  }
+
+  // Triangulation of the seam
+  std::vector<size_t> seam_vertices;
+  for (size_t v = TriangleMesh::v_start_offset; v < vertex_count; v++)
+    if (in_seam[v] || (!covered[v] && ids[v - TriangleMesh::v_start_offset] == v)) seam_vertices.push_back(v);
+  stats.seam_points = seam_vertices.size();
+
+  std::vector<Vector> seam_points(seam_vertices.size());
+  for (size_t i = 0; i < seam_vertices.size(); i++)
+    seam_points[i] = points[seam_vertices[i] - TriangleMesh::v_start_offset];
+
+  DelaunayTriangulation2D seam_tri(kernel);
+  const std::vector<size_t> seam_ids = seam_tri.build(seam_points);
+
+  TriangleMesh seam = seam_tri.extract_mesh();
+  if (seam.triangles.empty()) return false;
+
+  // The copies left in the seam are one vertex of it, the first one keeps it
+  std::vector<size_t> seam_to_global(seam.vertices.size(), TriangleMesh::infinite_point);
+  std::vector<size_t> global_to_seam(vertex_count, size_t_max);
+  for (size_t i = 0; i < seam_ids.size(); i++){
+    size_t& global = seam_to_global[seam_ids[i]];
+    if (global == TriangleMesh::infinite_point) global = seam_vertices[i];
+    else ids[seam_vertices[i] - TriangleMesh::v_start_offset] = global;
+    global_to_seam[seam_vertices[i]] = seam_ids[i];
+  }
+
+  TriangleMesh out;
+  out.vertices.insert(out.vertices.end(), points.begin(), points.end());
+  out.triangles = std::move(kept);
+  if (!SeamStitch::fill_holes(out, seam, seam_to_global, global_to_seam)) return false;
+  stats.seam_triangles = out.triangles.size() - kept_count;
+
+  for (size_t i = 0; i < points.size(); i++)
+    if (ids[i] != i + TriangleMesh::v_start_offset) out.free_vertices.push_back(i + TriangleMesh::v_start_offset);
+
+  assert_triangle_mesh_valid(out);
+  mesh = std::move(out);
+  return true;
+}
+
+namespace TriMeshAlgorithm {
+  SeamCheck verify_seams(const TriangleMesh& mesh, const TileManifest& manifest){
+    std::vector<size_t> owner(mesh.triangles.size(), no_tile);
+
+    #pragma omp parallel for schedule(static)
+    for (long t = 0; t < long(mesh.triangles.size()); t++){
+      const MTriangle& tri = mesh.triangles[t];
+      if (!tri.is_free() && !tri.is_infinite())
+        owner[t] = keeping_tile(manifest, canonical_vertices(mesh, tri));
+    }
+
+    SeamCheck check;
+    size_t edges = 0;
+
+    #pragma omp parallel
+    {
+      std::vector<std::pair<size_t, LocalId<3>>> failures;
+
+      #pragma omp for schedule(static) reduction(+: edges)
+      for (long t = 0; t < long(mesh.triangles.size()); t++){
+        const MTriangle& tri = mesh.triangles[t];
+        if (tri.is_free() || tri.is_infinite()) continue;
+
+        for (int e = 0; e < 3; e++){
+          const size_t o = tri.opposite_triangle[e];
+          // Each finite edge once, from its smallest triangle
+          if (!mesh.triangles[o].is_infinite() && o < size_t(t)) continue;
+          if (owner[t] != no_tile && owner[t] == owner[o]) continue;
+
+          edges++;
+          if (!is_edge_delaunay_2d(mesh, t, LocalId<3>(e)))
+            failures.push_back({ t, LocalId<3>(e) });
+        }
+      }
+
+      #pragma omp critical
+      check.failures.insert(check.failures.end(), failures.begin(), failures.end());
+    }
+
+    check.edges = edges;
+    std::sort(check.failures.begin(), check.failures.end());
+    return check;
+  }
+}
@@ -0,0 +1,109 @@
+#include <tp_geom/vertex_store.h>
+#include <algorithm>
+
+template <typename Real>
+VertexStore<Real>::VertexStore(const std::vector<Vector>& points, bool with_z): with_z(with_z) {
+  resize(points.size());
+
+  #pragma omp parallel for schedule(static)
+  for (long i = 0; i < long(points.size()); i++)
+    set(i, points[i]);
+}
+
+template <typename Real>
+void VertexStore<Real>::reserve(size_t n){
+  x.reserve(n);
+  y.reserve(n);
+  if (with_z) z.reserve(n);
+}
+
+template <typename Real>
+void VertexStore<Real>::resize(size_t n){
+  x.resize(n);
+  y.resize(n);
+  if (with_z) z.resize(n);
+}
+
+template <typename Real>
+void VertexStore<Real>::clear(){
+  x.clear();
+  y.clear();
+  z.clear();
+}
+
+template <typename Real>
+size_t VertexStore<Real>::push_back(const Vector& point){
+  x.push_back(Real(point[0]));
+  y.push_back(Real(point[1]));
+  if (with_z) z.push_back(Real(point[2]));
+  return x.size() - 1;
+}
+
+template <typename Real>
+void VertexStore<Real>::set(size_t id, const Vector& point){
+  x[id] = Real(point[0]);
+  y[id] = Real(point[1]);
+  if (with_z) z[id] = Real(point[2]);
+}
+
+template <typename Real>
+std::vector<Vector> VertexStore<Real>::to_vectors() const {
+  std::vector<Vector> points(size());
+
+  #pragma omp parallel for schedule(static)
+  for (long i = 0; i < long(points.size()); i++)
+    points[i] = get(i);
+
+  return points;
+}
+
+template <typename Real>
+std::vector<Real> VertexStore<Real>::interleaved() const {
+  const size_t stride = with_z ? 3 : 2;
+  std::vector<Real> buffer(stride * size());
+
+  #pragma omp parallel for schedule(static)
+  for (long i = 0; i < long(size()); i++){
+    buffer[stride * i] = x[i];
+    buffer[stride * i + 1] = y[i];
+    if (with_z) buffer[stride * i + 2] = z[i];
+  }
+
+  return buffer;
+}
+
+namespace {
+  // Min and max of values[begin, end), one running pair per lane of a cache line so that the loop vectorizes
+  template <typename Real>
+  std::pair<Real, Real> lane_minmax(const Real* values, size_t begin, size_t end){
+    constexpr size_t lanes = 64 / sizeof(Real);
+    Real lo[lanes], hi[lanes];
+    std::fill(lo, lo + lanes, values[begin]);
+    std::fill(hi, hi + lanes, values[begin]);
+
+    size_t i = begin;
+    for (; i + lanes <= end; i += lanes)
+      for (size_t k = 0; k < lanes; k++){
+        lo[k] = std::min(lo[k], values[i + k]);
+        hi[k] = std::max(hi[k], values[i + k]);
+      }
+    for (; i < end; i++){
+      lo[0] = std::min(lo[0], values[i]);
+      hi[0] = std::max(hi[0], values[i]);
+    }
+
+    return { *std::min_element(lo, lo + lanes), *std::max_element(hi, hi + lanes) };
+  }
+}
+
+template <typename Real>
+std::array<Real, 4> VertexStore<Real>::planar_bounds(size_t begin) const {
+  if (begin >= size()) return { 0, 0, 0, 0 };
+
+  const auto [min_x, max_x] = lane_minmax(x.data(), begin, size());
+  const auto [min_y, max_y] = lane_minmax(y.data(), begin, size());
+  return { min_x, min_y, max_x, max_y };
+}
+
+template struct VertexStore<float>;
+template struct VertexStore<double>;
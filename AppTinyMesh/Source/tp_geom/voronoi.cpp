@@ -0,0 +1,243 @@
+#include <tp_geom/voronoi.h>
+#include <tp_geom/predicates.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// The corners of each cell are counted by a sweep over the triangles, the prefix sum of the counts gives
+// the offsets, then the cells are filled. A cell whose circumcenters are all inside of the box only
+// references them, in the order of a turn around the vertex. The others (hull cells, cells going out of the box)
+// are the box clipped by the bisectors between the vertex and its neighbours, their corners are new points
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define TP_GEOM_TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define TP_GEOM_TARGET_CLONES
+#endif
+
+using Predicates::SoaPoints;
+
+namespace {
+  // One lane per triangle, a flat triangle gives a non finite center
+  TP_GEOM_TARGET_CLONES
+  void circumcenters_batch(size_t n, SoaPoints a, SoaPoints b, SoaPoints c, double* x, double* y){
+    #pragma omp simd
+    for (size_t i = 0; i < n; i++){
+      const double bx = b.x[i] - a.x[i], by = b.y[i] - a.y[i];
+      const double cx = c.x[i] - a.x[i], cy = c.y[i] - a.y[i];
+      const double d = 2 * (bx * cy - by * cx);
+      const double b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+      x[i] = a.x[i] + (cy * b2 - by * c2) / d;
+      y[i] = a.y[i] + (bx * c2 - cx * b2) / d;
+    }
+  }
+
+  struct ClippedCell {
+    size_t vertex;
+    std::vector<double> x, y;
+  };
+
+  // Box rectangle cut by the half planes closer to the vertex than to each of its neighbours (Sutherland-Hodgman)
+  ClippedCell clip_cell(const TriangleMesh& mesh, size_t vertex, const Box& bounds){
+    ClippedCell cell{ vertex, { bounds[0][0], bounds[1][0], bounds[1][0], bounds[0][0] }, { bounds[0][1], bounds[0][1], bounds[1][1], bounds[1][1] } };
+    std::vector<double> out_x, out_y;
+    const Vector& p = mesh.vertices[vertex];
+
+    const size_t start = mesh.vertex_to_triangle[vertex];
+    size_t tri_id = start;
+    do {
+      const MTriangle& tri = mesh.triangles[tri_id];
+      const LocalId<3> id = tri.local_id_of(vertex);
+      tri_id = tri.opposite_triangle[id + 1];
+
+      const size_t neighbour = tri.vertices[id + 1];
+      if (neighbour == mesh.infinite_point) continue;
+
+      // Kept side : (q - m).n <= 0, m the middle of the edge and n its direction
+      const Vector& u = mesh.vertices[neighbour];
+      const double nx = u[0] - p[0], ny = u[1] - p[1];
+      const double offset = nx * (u[0] + p[0]) / 2 + ny * (u[1] + p[1]) / 2;
+      const auto side = [&](size_t i){ return nx * cell.x[i] + ny * cell.y[i] - offset; };
+
+      out_x.clear();
+      out_y.clear();
+      for (size_t i = 0; i < cell.x.size(); i++){
+        const size_t j = i + 1 == cell.x.size() ? 0 : i + 1;
+        const double si = side(i), sj = side(j);
+
+        if (si <= 0){
+          out_x.push_back(cell.x[i]);
+          out_y.push_back(cell.y[i]);
+        }
+
+        if ((si < 0 && sj > 0) || (si > 0 && sj < 0)){
+          const double t = si / (si - sj);
+          out_x.push_back(cell.x[i] + t * (cell.x[j] - cell.x[i]));
+          out_y.push_back(cell.y[i] + t * (cell.y[j] - cell.y[i]));
+        }
+      }
+
+      std::swap(cell.x, out_x);
+      std::swap(cell.y, out_y);
+    } while (tri_id != start && !cell.x.empty());
+
+    return cell;
+  }
+}
+
+double VoronoiDiagram::cell_area(size_t v) const {
+  const size_t* corners = cell_begin(v);
+  const size_t size = cell_size(v);
+
+  double area = 0;
+  for (size_t i = 0; i < size; i++){
+    const size_t a = corners[i], b = corners[i + 1 == size ? 0 : i + 1];
+    area += x[a] * y[b] - x[b] * y[a];
+  }
+
+  return area / 2;
+}
+
+std::vector<double> VoronoiDiagram::cell_areas() const {
+  std::vector<double> areas(cell_count());
+
+  #pragma omp parallel for schedule(static)
+  for (long v = 0; v < long(areas.size()); v++)
+    areas[v] = cell_area(v);
+
+  return areas;
+}
+
+void VoronoiDiagram::write(std::ostream& stream) const {
+  const auto write_array = [&](const auto& array){
+    const uint64_t size = array.size();
+    stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    stream.write(reinterpret_cast<const char*>(array.data()), std::streamsize(size * sizeof(array[0])));
+  };
+
+  write_array(x);
+  write_array(y);
+  write_array(cell_offsets);
+  write_array(cell_corners);
+}
+
+namespace TriMeshAlgorithm {
+  void circumcenters(const TriangleMesh& mesh, std::vector<double>& x, std::vector<double>& y){
+    constexpr size_t chunk_size = 1024;
+    x.resize(mesh.triangles.size());
+    y.resize(mesh.triangles.size());
+
+    // The corners of each chunk are gathered then computed in one batch
+    const long chunks = long((mesh.triangles.size() + chunk_size - 1) / chunk_size);
+
+    #pragma omp parallel
+    {
+      std::vector<double> coords[6];
+      for (auto& c : coords) c.resize(chunk_size);
+
+      #pragma omp for schedule(static)
+      for (long c = 0; c < chunks; c++){
+        const size_t begin = c * chunk_size;
+        const size_t end = std::min(mesh.triangles.size(), begin + chunk_size);
+
+        for (size_t t = begin; t < end; t++){
+          const MTriangle& tri = mesh.triangles[t];
+          const bool finite = !tri.is_free() && !tri.is_infinite();
+
+          for (int k = 0; k < 3; k++){
+            coords[2 * k][t - begin] = finite ? mesh.vertices[tri.vertices[k]][0] : 0;
+            coords[2 * k + 1][t - begin] = finite ? mesh.vertices[tri.vertices[k]][1] : 0;
+          }
+        }
+
+        circumcenters_batch(end - begin, { coords[0].data(), coords[1].data() }, { coords[2].data(), coords[3].data() },
+          { coords[4].data(), coords[5].data() }, x.data() + begin, y.data() + begin);
+      }
+    }
+  }
+
+  VoronoiDiagram voronoi(const TriangleMesh& mesh, const Box& bounds){
+    VoronoiDiagram diagram;
+    circumcenters(mesh, diagram.x, diagram.y);
+
+    // The comparisons fail on the NaN of the infinite triangles
+    const double x0 = bounds[0][0], y0 = bounds[0][1], x1 = bounds[1][0], y1 = bounds[1][1];
+    const auto inside = [&](size_t t){
+      return diagram.x[t] >= x0 && diagram.x[t] <= x1 && diagram.y[t] >= y0 && diagram.y[t] <= y1;
+    };
+
+    // Degree of each vertex, the vertices of a triangle whose circumcenter is out of the box are clipped
+    const size_t vertex_count = mesh.vertices.size();
+    diagram.cell_offsets.assign(vertex_count + 1, 0);
+    std::vector<char> clip(vertex_count, false);
+
+    for (size_t t = 0; t < mesh.triangles.size(); t++){
+      const MTriangle& tri = mesh.triangles[t];
+      if (tri.is_free()) continue;
+
+      const bool out = !inside(t);
+      for (size_t v : tri.vertices){
+        diagram.cell_offsets[v + 1]++;
+        clip[v] |= out;
+      }
+    }
+
+    diagram.cell_offsets[mesh.infinite_point + 1] = 0;
+    std::vector<size_t> to_clip;
+    for (size_t v = TriangleMesh::v_start_offset; v < vertex_count; v++)
+      if (clip[v] && !mesh.is_free_vertex(v)) to_clip.push_back(v);
+
+    std::vector<ClippedCell> clipped(to_clip.size());
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (long i = 0; i < long(to_clip.size()); i++){
+      clipped[i] = clip_cell(mesh, to_clip[i], bounds);
+      diagram.cell_offsets[to_clip[i] + 1] = clipped[i].x.size();
+    }
+
+    for (size_t v = 0; v < vertex_count; v++)
+      diagram.cell_offsets[v + 1] += diagram.cell_offsets[v];
+
+    // The clipped corners follow the circumcenters, in the order of the vertices
+    diagram.cell_corners.resize(diagram.cell_offsets.back());
+
+    for (const ClippedCell& cell : clipped){
+      size_t* corners = diagram.cell_corners.data() + diagram.cell_offsets[cell.vertex];
+      for (size_t i = 0; i < cell.x.size(); i++)
+        corners[i] = diagram.x.size() + i;
+
+      diagram.x.insert(diagram.x.end(), cell.x.begin(), cell.x.end());
+      diagram.y.insert(diagram.y.end(), cell.y.begin(), cell.y.end());
+    }
+
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for (long v = 0; v < long(vertex_count); v++){
+      if (v == mesh.infinite_point || clip[v] || mesh.is_free_vertex(v)) continue;
+
+      size_t* corners = diagram.cell_corners.data() + diagram.cell_offsets[v];
+      const size_t start = mesh.vertex_to_triangle[v];
+      size_t tri_id = start;
+      do {
+        *corners++ = tri_id;
+        const MTriangle& tri = mesh.triangles[tri_id];
+        tri_id = tri.opposite_triangle[tri.local_id_of(v) + 1];
+      } while (tri_id != start);
+    }
+
+    return diagram;
+  }
+
+  VoronoiDiagram voronoi(const TriangleMesh& mesh){
+    Vector low(std::numeric_limits<double>::infinity()), high(-std::numeric_limits<double>::infinity());
+
+    for (size_t v = TriangleMesh::v_start_offset; v < mesh.vertices.size(); v++){
+      if (mesh.is_free_vertex(v)) continue;
+      const Vector& p = mesh.vertices[v];
+      low = Vector(std::min(low[0], p[0]), std::min(low[1], p[1]), std::min(low[2], p[2]));
+      high = Vector(std::max(high[0], p[0]), std::max(high[1], p[1]), std::max(high[2], p[2]));
+    }
+
+    return voronoi(mesh, Box(low, high));
+  }
+}